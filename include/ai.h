@@ -3,51 +3,128 @@
 
 #include "types.h"
 #include "bitboard.h"
+#include "evaluate.h"
+#include "tt.h"
 #include <stdint.h>
+#include <stdatomic.h>
 
 // --- 搜索参数 ---
+// 都可以在编译时用 -D 覆盖（如 make variant VARIANT_FLAGS="-DBEAM_WIDTH=12"），用于对照测试
+#ifndef SEARCH_DEPTH
 #define SEARCH_DEPTH 12
+#endif
+#ifndef BEAM_WIDTH
 #define BEAM_WIDTH 10
+#endif
 #define MAX_DEPTH (SEARCH_DEPTH + 1)
+// 走法排序时防守分的权重（右移位数）
+#ifndef ORDER_DEFENCE_SHIFT
+#define ORDER_DEFENCE_SHIFT 1
+#endif
 
 
-#define MAX_LINES 30 // 最大对角线数为29
 #define INVALID_POS ((Position){-1, -1})
+// 分数超过它视为已经找到胜手
+#define WIN_THRESHOLD 90000
 
 
 typedef struct {
-    // 缓存4个方向的净分（黑分-白分）
-    // [0]: 列, [1]: 行, [2]: 主对角线, [3]: 副对角线
-    long long line_net_scores[4][MAX_LINES];
-
-    // 缓存上一步可能触发禁手的总数目
-    long long count_live3[4][MAX_LINES];
-    long long count_4[4][MAX_LINES];
-
-    long long total_score; // 全局分数 = 所有方向净分之和
-} EvalState;
-
-
-typedef struct {
-    Line move_mask_backup[15]; // 备份邻域掩码
-    long long old_line_net_scores[4]; // 备份受影响的4条线的旧分数
-    long long old_total_score;
-    long long old_count_live3[4]; // 备份受影响的4条线的旧活三数
-    long long old_count_4[4]; // 备份受影响的4条线的旧四数
+    int old_total_score;
+#if EVAL_BACKEND != EVAL_BACKEND_WINDOW
+    int old_line_net_scores[4];      // 备份受影响的4条线的旧分数
+#endif
 } UndoInfo;
 
-
-
-
 typedef struct {
     Position killer_moves[MAX_DEPTH][2]; // 杀手着法
     unsigned long long nodes_searched;   // 已搜索节点数
+    RuleType rule;                       // 标准规则下黑方受禁手限制
 
     // 线程本地棋盘与评估状态
     BitBoardState board;
     EvalState eval;
+    ForbiddenMap forbidden; // 黑方禁手点，随 make/unmake 增量标记，用到时才重新判断
+
+    // 置换表与搜索预算
+    TranspositionTable* tt;
+    unsigned long long max_nodes; // 0 为不限
+    double deadline;              // 截止时刻（searchClock 秒），0 为不限
+    int stopped;                  // 预算用完，正在退出搜索
+    const atomic_int* stop_flag;  // 其他线程请求停止（见 SearchControl），NULL 为不检查
 } SearchContext;
 
-Position getAIMove(const GameState *game); // 获取AI落子
+// 搜索限制
+typedef struct {
+    int max_depth; // 迭代加深的最大深度（<=0 时使用 SEARCH_DEPTH）
+    int verbose;   // 是否打印每层的搜索信息
+    unsigned long long max_nodes; // 节点预算，0 为不限
+    double max_time;              // 时间预算（秒），0 为不限
+    TranspositionTable* tt;       // 使用的置换表，NULL 时使用全局默认表
+    const Position* exclude;      // 根节点不考虑的走法（多主变：依次排除已找到的最佳走法再搜索），可为 NULL
+    int exclude_count;
+} SearchLimits;
+
+// 迭代加深每次加深2层
+#define MAX_ITERATIONS (SEARCH_DEPTH / 2)
+
+// 完成的一次迭代
+typedef struct {
+    int depth;
+    int score;
+    Position best_move;
+    unsigned long long nodes;  // 到这一层完成时的累计节点数
+    double time;               // 到这一层完成时的累计用时（秒）
+} SearchIteration;
+
+// 搜索结果
+typedef struct {
+    Position best_move;
+    int score;                 // 最佳走法的分数（当前玩家视角）
+    int depth;                 // 完成的最大迭代深度
+    unsigned long long nodes;  // 搜索节点数
+    SearchIteration iterations[MAX_ITERATIONS]; // 每层迭代的结果
+    int iteration_count;
+} SearchResult;
+
+// 一次完成的迭代，交给进度回调
+typedef struct {
+    int depth;
+    int score;                 // 当前玩家视角
+    Position pv[MAX_DEPTH];    // 主变：最佳根走法，之后沿置换表中各局面的最佳走法展开
+    int pv_length;
+    unsigned long long nodes;  // 累计节点数
+    double time;               // 累计用时（秒）
+    double nps;
+    int hashfull;              // 置换表占用率（千分比）
+} SearchInfo;
+
+typedef void (*SearchInfoCallback)(const SearchInfo *info, void *user);
+
+// 搜索控制：从其他线程停止搜索，以及接收每次迭代的进度
+typedef struct {
+    const atomic_int* stop;     // 变为非0后搜索在 1024 个节点内停下，结果同预算用完
+    SearchInfoCallback on_info; // 每完成一次迭代在搜索线程中调用一次，可为 NULL
+    void *user;
+} SearchControl;
+
+// 初始化搜索用到的只读全局表（Zobrist、评估内核、禁手掩码等）
+// 只执行一次且线程安全，aiSearch / engine_new 会自动调用
+void aiInit(void);
+
+// 按局面初始化搜索上下文：棋盘、禁手图、整盘评估与根节点哈希，tt 为 NULL 时使用全局默认表
+// 预算字段保持为0（不限）
+void aiContextInit(SearchContext* ctx, const GameState* game, TranspositionTable* tt);
+
+// 搜索中的增量落子与撤销：更新位棋盘、哈希、禁手图与 EvalState
+// 落子点必须为空（黑方也不应是禁手点），撤销必须按落子的逆序进行
+void aiMakeMove(SearchContext* ctx, int row, int col, Player player, UndoInfo* undo);
+void aiUnmakeMove(SearchContext* ctx, int row, int col, Player player, const UndoInfo* undo);
+
+// 按给定限制搜索当前局面，result 可为 NULL
+// 节点或时间预算用完时，返回最后一次完成的迭代深度的结果（一层都没完成时返回当前最好的根走法）
+Position aiSearch(const GameState *game, const SearchLimits *limits, SearchResult *result);
+// 同 aiSearch，另外按 control 检查停止请求并报告进度，control 可为 NULL
+Position aiSearchControlled(const GameState *game, const SearchLimits *limits, const SearchControl *control,
+                            SearchResult *result);
 
 #endif
@@ -0,0 +1,28 @@
+#ifndef ANNOTATE_H
+#define ANNOTATE_H
+
+#include "types.h"
+
+// 批量标注棋谱：对每盘棋的每个局面做一次有预算的搜索，
+// 给出引擎分数、最佳走法，以及实战走法相对最佳走法的损失，损失过大的标为败着。
+// 输入文件逐个处理，每读满一批（最多1024盘）交给 OpenMP 线程池，每个线程有自己的置换表
+// （SearchContext 本来就是每次搜索独立的）。每盘写进自己的缓冲，线程之间不按顺序互相等待，
+// 一批完成后按对局顺序写到 <输入文件>.ann；没有对局的文件也写出只有文件头的 .ann。
+
+typedef struct {
+    int max_depth;                // 每个局面的搜索深度上限
+    unsigned long long max_nodes; // 每个局面的节点预算，0 为不限
+    double max_time;              // 每个局面的时间预算（秒），0 为不限
+    int threads;                  // 工作线程数，<=0 时由 OpenMP 决定
+    int tt_mb;                    // 每个线程的置换表大小
+    int blunder;                  // 损失不小于该分数的走法标为败着
+    RuleType rule;                // 不带规则信息的格式所用的规则
+} AnnotateOptions;
+
+// 默认选项：深度8，不限节点与时间，每线程16MB置换表
+void annotateDefaults(AnnotateOptions *options);
+
+// 标注 paths 中的所有棋谱（格式见 interchange.h），全部成功返回1；置换表分配失败时不标注，返回0
+int annotateFiles(char **paths, int count, const AnnotateOptions *options);
+
+#endif
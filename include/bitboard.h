@@ -2,6 +2,7 @@
 #define BITBOARD_H
 
 #include "types.h"
+#include "board256.h"
 
 // 初始化位棋盘
 void initBitBoard(BitBoardState *bitBoard);
@@ -10,15 +11,19 @@ void initBitBoard(BitBoardState *bitBoard);
 // // 获取当前落子掩码
 // void getMoveMask(const BitBoardState *bitBoard, Line* buffer);
 
-// 落子后更新 BitBoard
-// backup_mask: [OUT] 用于存储之前 move_mask 的缓冲区（大小：BOARD_SIZE * sizeof(Line)）
-void updateBitBoard(BitBoardState *bitBoard, int row, int col, Player player, Line* backup_mask);
+// 落子后更新 BitBoard（4个方向的线、整盘位棋盘与哈希）
+void updateBitBoard(BitBoardState *bitBoard, int row, int col, Player player);
 
 // 撤销 BitBoard 上的一步落子
-// backup_mask: [IN] 在更新时存储的 move_mask
-void undoBitBoard(BitBoardState *bitBoard, int row, int col, Player player, const Line* backup_mask);
+void undoBitBoard(BitBoardState *bitBoard, int row, int col, Player player);
 
-// 根据 move_mask 生成所有合法落子
+// 双方棋子的并集
+Board256 occupiedBoard256(const BitBoardState *bitBoard);
+
+// 候选落子点：所有棋子米字形5x5邻域内的空位（对整盘位棋盘做膨胀得到）
+Board256 candidateBoard256(const BitBoardState *bitBoard);
+
+// 生成所有合法落子（candidateBoard256 按列优先顺序展开）
 // moves: [OUT] 用于存储合法的落子点（最多 225 个）
 // 返回值：生成的落子数量
 int generateMoves(const BitBoardState *bitBoard, Position *moves);
@@ -2,12 +2,23 @@
 #define BOARD_H
 
 #include "types.h"
+#include "board256.h"
+
+// 棋盘以 bitBoard 为唯一来源，按格子查询时从双方的整盘位棋盘中读出
+static inline CellState getCell(const GameState *game, int row, int col) {
+    if (board256Test(&game->bitBoard.stones[LINE_SIDE(PLAYER_BLACK)], row, col)) return BLACK;
+    if (board256Test(&game->bitBoard.stones[LINE_SIDE(PLAYER_WHITE)], row, col)) return WHITE;
+    return EMPTY;
+}
 
 void initGame(GameState *game, GameMode mode, RuleType rule);
 void printBoard(const GameState *game);
 
 //1 if ok, else error
 int makeMove(GameState *game, int row, int col); 
+// 不做合法性检查的落子，用于回放可信的棋谱（如二进制棋谱库）
+// 禁手位图只标记受影响的点，回放结束后需 forbiddenMapResolve 一次（见 corpusReplay）
+void makeMoveTrusted(GameState *game, int row, int col);
 int isBoardFull(const GameState *game);
 
 #endif
@@ -0,0 +1,154 @@
+#ifndef BOARD256_H
+#define BOARD256_H
+
+#include "types.h"
+
+// 整盘位棋盘 (Board256) 的位运算
+// 按列存放: 每列16位（位 = 行，第15位恒为0），每个64位字存4列，共4个字
+// 列 c 位于 w[c / 4] 的第 (c % 4) * 16 位起
+// 所有运算都是定长的4字循环，没有分支，编译器可以直接向量化成一个 256 位寄存器的运算
+
+#define B256_COL_BITS 16
+#define B256_COLS_PER_WORD 4
+#define B256_WORDS 4
+
+// 每列只保留第0~14行
+#define B256_ROW_MASK 0x7FFF7FFF7FFF7FFFULL
+// 第15列不存在
+#define B256_LAST_WORD_MASK 0x00007FFF7FFF7FFFULL
+
+#define B256_WORD(col) ((col) / B256_COLS_PER_WORD)
+#define B256_SHIFT(row, col) (((col) % B256_COLS_PER_WORD) * B256_COL_BITS + (row))
+
+static inline Board256 board256Zero(void) {
+    Board256 r = {{0, 0, 0, 0}};
+    return r;
+}
+
+// 棋盘上所有的格子
+static inline Board256 board256Full(void) {
+    Board256 r = {{B256_ROW_MASK, B256_ROW_MASK, B256_ROW_MASK, B256_LAST_WORD_MASK}};
+    return r;
+}
+
+static inline void board256Set(Board256 *b, int row, int col) {
+    b->w[B256_WORD(col)] |= 1ULL << B256_SHIFT(row, col);
+}
+
+static inline void board256Reset(Board256 *b, int row, int col) {
+    b->w[B256_WORD(col)] &= ~(1ULL << B256_SHIFT(row, col));
+}
+
+static inline int board256Test(const Board256 *b, int row, int col) {
+    return (int)((b->w[B256_WORD(col)] >> B256_SHIFT(row, col)) & 1);
+}
+
+// 取出一列（16位，位 = 行）
+static inline Line board256Column(const Board256 *b, int col) {
+    return (Line)(b->w[B256_WORD(col)] >> ((col % B256_COLS_PER_WORD) * B256_COL_BITS));
+}
+
+static inline Board256 board256Or(Board256 a, Board256 b) {
+    for (int i = 0; i < B256_WORDS; i++) a.w[i] |= b.w[i];
+    return a;
+}
+
+static inline Board256 board256And(Board256 a, Board256 b) {
+    for (int i = 0; i < B256_WORDS; i++) a.w[i] &= b.w[i];
+    return a;
+}
+
+// a & ~b
+static inline Board256 board256AndNot(Board256 a, Board256 b) {
+    for (int i = 0; i < B256_WORDS; i++) a.w[i] &= ~b.w[i];
+    return a;
+}
+
+static inline int board256IsEmpty(Board256 a) {
+    return (a.w[0] | a.w[1] | a.w[2] | a.w[3]) == 0;
+}
+
+static inline int board256Count(Board256 a) {
+    return __builtin_popcountll(a.w[0]) + __builtin_popcountll(a.w[1]) +
+           __builtin_popcountll(a.w[2]) + __builtin_popcountll(a.w[3]);
+}
+
+// 每列16位各复制一份
+#define B256_LANES(bits) ((unsigned long long)(bits) * 0x0001000100010001ULL)
+
+// 沿行方向平移 n 格（n > 0 向行号增大的方向），n 取 -2..2
+// 只有1位的填充位挡不住2格的平移，所以按方向清掉从相邻列移进来的行:
+// 向下平移 n 格后第0~n-1行为空，向上平移 n 格后第 15-n~14 行为空
+static inline Board256 board256ShiftRows(Board256 a, int n) {
+    unsigned long long mask = (n >= 0) ? B256_LANES((0x7FFFu << n) & 0x7FFFu) : B256_LANES(0x7FFFu >> -n);
+    for (int i = 0; i < B256_WORDS; i++) {
+        a.w[i] = ((n >= 0) ? (a.w[i] << n) : (a.w[i] >> -n)) & mask;
+    }
+    return a;
+}
+
+// 沿列方向平移 n 格（n > 0 向列号增大的方向），n 取 -3..3
+static inline Board256 board256ShiftCols(Board256 a, int n) {
+    Board256 r;
+    if (n == 0) return a;
+    if (n > 0) {
+        int bits = n * B256_COL_BITS;
+        r.w[0] = a.w[0] << bits;
+        for (int i = 1; i < B256_WORDS; i++) r.w[i] = (a.w[i] << bits) | (a.w[i - 1] >> (64 - bits));
+    } else {
+        int bits = -n * B256_COL_BITS;
+        for (int i = 0; i < B256_WORDS - 1; i++) r.w[i] = (a.w[i] >> bits) | (a.w[i + 1] << (64 - bits));
+        r.w[B256_WORDS - 1] = a.w[B256_WORDS - 1] >> bits;
+    }
+    r.w[B256_WORDS - 1] &= B256_LAST_WORD_MASK;
+    return r;
+}
+
+// 3x3 膨胀（含自身）
+static inline Board256 board256Dilate1(Board256 a) {
+    Board256 v = board256Or(a, board256Or(board256ShiftRows(a, 1), board256ShiftRows(a, -1)));
+    return board256Or(v, board256Or(board256ShiftCols(v, 1), board256ShiftCols(v, -1)));
+}
+
+// 5x5 米字形膨胀（含自身）: 3x3 邻域 + 8个方向上距离为2的格子
+// 即同列上下2格、相邻列上下1格、隔一列的同行及斜向2格
+static inline Board256 board256DilateStar2(Board256 a) {
+    Board256 king = board256Dilate1(a);
+    // 行号差为 -2, 0, 2 的格子，再向左右平移2列得到距离为2的横向与斜向格子
+    Board256 rows2 = board256Or(board256ShiftRows(a, 2), board256ShiftRows(a, -2));
+    Board256 v = board256Or(a, rows2);
+    Board256 cols2 = board256Or(board256ShiftCols(v, 2), board256ShiftCols(v, -2));
+    return board256Or(king, board256Or(rows2, cols2));
+}
+
+// 取出并清除最低位的格子（按列优先、行号从小到大的顺序），集合为空时返回0
+static inline int board256PopFirst(Board256 *b, int *row, int *col) {
+    for (int i = 0; i < B256_WORDS; i++) {
+        if (b->w[i]) {
+            int t = __builtin_ctzll(b->w[i]);
+            b->w[i] &= b->w[i] - 1;
+            *col = i * B256_COLS_PER_WORD + t / B256_COL_BITS;
+            *row = t % B256_COL_BITS;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 把集合中的格子按列优先顺序写入 moves，返回数量
+static inline int board256ToMoves(Board256 b, Position *moves) {
+    int count = 0;
+    for (int i = 0; i < B256_WORDS; i++) {
+        unsigned long long m = b.w[i];
+        while (m) {
+            int t = __builtin_ctzll(m);
+            moves[count].row = t % B256_COL_BITS;
+            moves[count].col = i * B256_COLS_PER_WORD + t / B256_COL_BITS;
+            count++;
+            m &= m - 1;
+        }
+    }
+    return count;
+}
+
+#endif
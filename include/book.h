@@ -0,0 +1,49 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "types.h"
+
+// 开局库：从棋谱（格式见 interchange.h）统计前 max_ply 步里每个局面下过的走法、次数与胜局数。
+// 每盘棋按棋盘的8种对称变换各计一次（变换后相同的局面与走法只计一次），局面用 Zobrist 哈希（含轮到谁走）加规则标识。
+// 棋谱没有记录结果时按终局是否成五判断胜方，仍无法判断的（如中途认输）只计入 count 不计入 decided。
+// bookFinish 之后条目按 (key, rule, move) 排好序且不再修改，多个线程可以不加锁地同时查询。
+
+#define BOOK_DEFAULT_PLY 12
+
+typedef struct {
+    uint64_t key;        // calculateZobristHash(局面, 轮到的一方)
+    unsigned char rule;  // RuleType
+    unsigned char move;  // CORPUS_MOVE(row, col)
+    unsigned int count;  // 下过的次数（按盘计）
+    unsigned int decided; // 其中已知胜负的盘数
+    unsigned int wins;   // 其中下这一步的一方最终获胜的次数
+} BookEntry;
+
+typedef struct {
+    BookEntry *entries;
+    size_t count, capacity;
+    int max_ply;
+    long long games;
+} OpeningBook;
+
+typedef struct {
+    Position move;
+    unsigned int count;
+    unsigned int decided;
+    unsigned int wins;
+} BookMove;
+
+// 空的开局库，max_ply <= 0 时使用 BOOK_DEFAULT_PLY
+void bookInit(OpeningBook *book, int max_ply);
+// 读入一个棋谱文件，rule 用于不带规则信息的格式；返回读入的盘数，失败返回 -1
+long long bookAddFile(OpeningBook *book, const char *path, RuleType rule);
+// 排序并合并相同的条目，之后只读
+int bookFinish(OpeningBook *book);
+void bookFree(OpeningBook *book);
+
+// 查询当前局面的库内走法，按次数从多到少最多写入 max 个，返回写入的个数
+int bookProbe(const OpeningBook *book, const GameState *game, BookMove *moves, int max);
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "types.h"
+
+// 二进制棋谱库 (.gmb)：一个文件存放任意多盘棋，用于批量导入
+// 布局: [CorpusHeader] [各盘的走法字节，首尾相接] [补0到8字节对齐] [CorpusIndexEntry x game_count]
+// 每步一个字节 row * BOARD_SIZE + col；索引放在文件末尾，写入时可以边下边写，不必预知盘数。
+// 早先写出的文件索引没有对齐，读取时条目逐个 memcpy 出来，不直接按结构体访问映射区。
+// 读取时整个文件 mmap 只读映射，CorpusGame 直接指向映射区，不做拷贝。
+
+#define CORPUS_MAGIC 0x424D4D47u // "GMMB"
+#define CORPUS_VERSION 1
+
+#define CORPUS_MOVE(row, col) ((unsigned char)((row) * BOARD_SIZE + (col)))
+#define CORPUS_ROW(m) ((m) / BOARD_SIZE)
+#define CORPUS_COL(m) ((m) % BOARD_SIZE)
+
+// 对局结果
+#define CORPUS_RESULT_UNKNOWN 0
+#define CORPUS_RESULT_BLACK PLAYER_BLACK
+#define CORPUS_RESULT_WHITE PLAYER_WHITE
+#define CORPUS_RESULT_DRAW 3
+
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    unsigned long long game_count;
+    unsigned long long index_offset; // 索引表的文件偏移
+} CorpusHeader;
+
+typedef struct {
+    unsigned long long offset;  // 走法字节的文件偏移
+    unsigned short move_count;
+    unsigned char rule;         // RuleType
+    unsigned char result;       // CORPUS_RESULT_*
+    unsigned int reserved;
+} CorpusIndexEntry;
+
+// 一盘棋的只读视图，moves 指向映射区
+typedef struct {
+    const unsigned char *moves;
+    int move_count;
+    RuleType rule;
+    int result;
+} CorpusGame;
+
+// 已映射的棋谱库
+typedef struct {
+    const unsigned char *base;
+    size_t size;
+    unsigned long long game_count;
+    const unsigned char *index;   // 索引表起点，不一定对齐
+} Corpus;
+
+// 写入器：走法直接写入文件，索引在内存中累积，关闭时写到文件末尾
+typedef struct {
+    FILE *fp;
+    unsigned long long offset;
+    CorpusIndexEntry *index;
+    unsigned long long game_count;
+    unsigned long long capacity;
+} CorpusWriter;
+
+// 打开 / 关闭棋谱库，成功返回1
+int corpusOpen(Corpus *corpus, const char *path);
+void corpusClose(Corpus *corpus);
+
+// 取第 i 盘棋，越界、索引损坏，或者这盘棋有越界坐标、重复落子、未知规则时返回0
+// （与 interchange 导入文本格式时的检查相同），之后可以直接按走法字节落子
+int corpusGame(const Corpus *corpus, unsigned long long i, CorpusGame *game);
+
+// 按棋谱复盘：initGame 后逐步 makeMoveTrusted，不做禁手与胜负检查
+// 走法字节越界或落在已有棋子的点上时停止并返回0
+int corpusReplay(GameState *game, const CorpusGame *record);
+
+// 写入
+int corpusWriterOpen(CorpusWriter *writer, const char *path);
+int corpusWriterAdd(CorpusWriter *writer, const unsigned char *moves, int move_count, RuleType rule, int result);
+// 把一局游戏的走子历史写成一盘棋
+int corpusWriterAddGame(CorpusWriter *writer, const GameState *game, int result);
+int corpusWriterClose(CorpusWriter *writer);
+
+#endif
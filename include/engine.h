@@ -0,0 +1,73 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "types.h"
+#include "ai.h"
+
+// 引擎实例：拥有自己的局面、置换表与默认搜索限制。
+// 实例之间不共享任何可变状态（Zobrist 表、评估内核、禁手掩码等只读全局表由 aiInit 一次性初始化），
+// 所以同一个进程里可以建多个实例，在不同线程中同时搜索；同一个实例不能被多个线程同时使用，
+// 例外是 engine_stop，可以在任何线程中调用。
+// 构建 make lib 得到 build/libgomoku.a 与 build/libgomoku.so。
+
+// 未指定时的置换表大小（MB）
+#define ENGINE_DEFAULT_TT_MB 64
+
+typedef struct Engine Engine;
+
+typedef struct {
+    int tt_mb;           // 置换表大小（MB），<=0 时使用 ENGINE_DEFAULT_TT_MB
+    SearchLimits limits; // engine_search 未给出限制时使用，tt 字段被忽略（总是使用实例自己的表）
+} EngineConfig;
+
+// 默认配置：64MB 置换表，深度 SEARCH_DEPTH，不限节点与时间
+void engine_default_config(EngineConfig *config);
+
+// 新建实例，config 为 NULL 时使用默认配置；初始局面为空棋盘、标准规则。内存不足时返回 NULL
+Engine *engine_new(const EngineConfig *config);
+void engine_free(Engine *engine);
+
+// 重新分配置换表（大小不变时保留内容），失败时返回0且实例不可再搜索
+int engine_resize_tt(Engine *engine, int tt_mb);
+// 清空置换表
+void engine_clear(Engine *engine);
+
+// 设置局面：按顺序落下 moves，非法落子时返回其错误码（见 rules.h）且局面停在该步之前，成功返回 VALID_MOVE
+int engine_set_position(Engine *engine, RuleType rule, const Position *moves, int count);
+// 设置局面：复制一份 GameState（可以是任意摆出的局面）
+void engine_set_game(Engine *engine, const GameState *game);
+// 在当前局面上落一步 / 悔一步，返回值同 makeMove / undoMove
+int engine_play(Engine *engine, int row, int col);
+int engine_undo(Engine *engine);
+// 当前局面（只读）
+const GameState *engine_game(const Engine *engine);
+
+// 搜索当前局面，limits 为 NULL 时使用实例配置中的限制；result 可为 NULL
+Position engine_search(Engine *engine, const SearchLimits *limits, SearchResult *result);
+
+// 之后的搜索（同步与后台）每完成一次迭代调用 on_info（在搜索线程中），NULL 为不报告
+void engine_set_info_callback(Engine *engine, SearchInfoCallback on_info, void *user);
+
+// 后台搜索：在新线程中搜索当前局面，立即返回；已经有后台搜索时返回0。
+// 搜索结束前不能修改局面（engine_play / engine_set_* 等），结束后必须用 engine_wait 回收。
+int engine_start(Engine *engine, const SearchLimits *limits);
+// 请求停止正在进行的搜索（同步或后台），不等待；搜索在 1024 个节点内返回最后完成的迭代的结果。
+// 停止标志一直保留到 engine_clear_stop、engine_start 或 engine_wait：同步搜索开始前收到的停止请求不会丢失，
+// 搜索一开始就返回
+void engine_stop(Engine *engine);
+// 清除停止标志，在确定下一次同步搜索要做什么时调用（如分配任务时，与发出停止请求的一方在同一把锁下）
+void engine_clear_stop(Engine *engine);
+// 后台搜索是否还没有结束
+int engine_searching(Engine *engine);
+// 等待后台搜索结束并取回结果，result 可为 NULL；没有后台搜索时返回 INVALID_POS
+Position engine_wait(Engine *engine, SearchResult *result);
+
+// 交互对局使用的默认实例（首次调用时创建，打印每层的搜索信息）
+Engine *engine_default(void);
+// 默认实例已经创建时返回它，否则返回 NULL（不会为此分配置换表）
+Engine *engine_default_if_created(void);
+
+// 获取AI落子：把局面交给默认实例搜索，并按分数设置字符画表情
+Position getAIMove(const GameState *game);
+
+#endif
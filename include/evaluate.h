@@ -14,6 +14,26 @@
 // 四的基数
 #define BASE_4 (1 << (_SHIFT / 2))
 
+// 增量评估后端（编译期选择，如 make table）
+// LINES4: 每步用 evaluateLines4 重新评估4条线
+// TABLE:  每步查表 (linetable.h)，表由 gen_linetable 在构建期生成
+// WINDOW: 只评估落子点前后各6格的窗口，直接返回总分变化，不缓存88条线
+#define EVAL_BACKEND_LINES4 0
+#define EVAL_BACKEND_TABLE  1
+#define EVAL_BACKEND_WINDOW 2
+
+#ifndef EVAL_BACKEND
+#define EVAL_BACKEND EVAL_BACKEND_LINES4
+#endif
+
+#if EVAL_BACKEND == EVAL_BACKEND_TABLE
+#define EVAL_BACKEND_NAME "table"
+#elif EVAL_BACKEND == EVAL_BACKEND_WINDOW
+#define EVAL_BACKEND_NAME "window"
+#else
+#define EVAL_BACKEND_NAME "lines4"
+#endif
+
 // 评分宏
 // 评分宏
 #define SCORE_FIVE           ((10000000) <<( _SHIFT))
@@ -26,6 +46,23 @@
 #define SCORE_LIVE_2         ((400) << (_SHIFT))
 #define SCORE_RUSH_2         ((50) << (_SHIFT))
 
+#define MAX_LINES 30 // 最大对角线数为29
+
+// 增量评估状态
+#if EVAL_BACKEND == EVAL_BACKEND_WINDOW
+typedef struct {
+    int total_score; // 全局分数，窗口后端只维护总分
+} EvalState;
+#else
+typedef struct {
+    // 缓存4个方向的净分（黑分-白分）
+    // [0]: 列, [1]: 行, [2]: 主对角线, [3]: 副对角线
+    int line_net_scores[4][MAX_LINES];
+
+    int total_score; // 全局分数 = 所有方向净分之和
+} EvalState;
+#endif
+
 //弃用api
 // 评估一条线（15位）
 // me: 当前玩家棋子的位掩码
@@ -54,8 +91,54 @@ typedef struct {
 
 // 并行评估双方的四条线
 // 返回双方所有4条线的打包分数
+// 实际计算由运行时选择的内核完成，各内核结果逐位一致
 DualLines evaluateLines4(Lines4 me, Lines4 enemy, Lines4 mask);
 
+// evaluateLines4 的内核
+// GENERIC: omp simd 模式匹配 + 标量 POPCOUNT64，任何平台可用
+// AVX2:    向量寄存器内完成模式匹配与计分，PSHUFB 半字节查表求 popcount
+// AVX512:  同上，popcount 使用 VPOPCNTD（需 AVX512_VPOPCNTDQ + AVX512VL）
+typedef enum {
+    EVAL_KERNEL_GENERIC = 0,
+    EVAL_KERNEL_AVX2,
+    EVAL_KERNEL_AVX512,
+    EVAL_KERNEL_COUNT
+} EvalKernel;
+
+// 按 cpuid 选择当前CPU支持的最快内核，环境变量 GOMOKU_KERNEL 可强制指定（generic/avx2/avx512）
+// 首次调用 evaluateLines4 时会自动执行
+void evaluateInit(void);
+
+// 指定内核，CPU不支持时返回0且保持原内核
+int evaluateSetKernel(EvalKernel kernel);
+EvalKernel evaluateGetKernel(void);
+int evaluateKernelSupported(EvalKernel kernel);
+const char *evaluateKernelName(EvalKernel kernel);
+
+// 窗口评估：只看落子点前后各6格（共13格），4个方向各占64位整数中的16位，
+// 双方落子前后共4个64位字一次评估，返回净分（黑-白）的变化量。
+// 调用时 (row, col) 上的棋子已经落下。
+// 窗口内出现五连时退回整线评估，以保持与 evaluateLines4 相同的结果。
+int evaluateWindowDelta(const BitBoardState *board, int row, int col);
+
+// 候选点评估结果（禁手由搜索按规则另行判断，见 renju.h）
+// attack: 落子方在该点落子后的局面分（落子方视角），与 aiMakeMove 后的 total_score 一致
+// defence: 对方在该点落子能得到的分数变化（对方视角）
+typedef struct {
+    int attack;
+    int defence;
+} CandidateScore;
+
+// 批量评估候选点：不修改棋盘，每批8个候选点的窗口一次完成模式匹配
+// moves 中的点必须为空位
+void evaluateCandidates(const BitBoardState *board, const EvalState *eval, const Position *moves, int n,
+                        Player player, CandidateScore *out);
+
+// 全盘扫描：所有长度不小于5的线（72条）按 [白 | 黑] / [黑 | 白] 打包成64位字，
+// 一次向量化模式匹配后填满 EvalState（单线语义与 evaluateLines2 一致）
+// 用于搜索入口与批量分析中的局面初始化
+void scanBoard(const BitBoardState *board, EvalState *eval);
+
 // 评估整个棋盘上某一玩家的分数
 // 返回所有线（纵向、横向、对角线）的分数总和
 int evaluateBoard(const BitBoardState *bitBoard, Player player);
@@ -3,8 +3,9 @@
 
 #include "types.h"
 
-void pushState(GameState *game);
+void pushMove(GameState *game, int row, int col); // makeMove 落子前调用，记录这一步并清掉可重做的步
 int undoMove(GameState *game); // Returns 1 if success, 0 if empty
+int redoMove(GameState *game); // Returns 1 if success, 0 if nothing to redo
 void clearHistory(GameState *game);
 
 #endif
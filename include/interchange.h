@@ -0,0 +1,63 @@
+#ifndef INTERCHANGE_H
+#define INTERCHANGE_H
+
+#include <stdio.h>
+#include "types.h"
+#include "corpus.h"
+
+// 外部棋谱格式的流式导入/导出，以及各格式之间的转换
+// 所有导入器都是单遍读取，内存占用与输入大小无关（只缓存当前一盘棋）。
+// 走法统一用 CorpusGame 传递（每步一个字节 row * 15 + col，见 corpus.h）。
+//
+// 支持的格式（按扩展名识别）:
+//   .txt  本项目的棋谱格式（record.h），多局可以首尾相接
+//   .gmb  二进制棋谱库（corpus.h）
+//   .psq  Gomocup / Piskvork 棋谱: 首行 "Piskvork 15x15, ..."，之后每行 "x,y,time"（从1开始，x 为列，y 为从上往下的行）
+//         遇到非走法行结束一局；多局可以首尾相接，每局以 "Piskvork" 行开头
+//   .pos  局面串: 每行一盘，走法写作列字母加行号（如 "h8i9g9" 或 "H8 I9 G9"），'#' 开头的行为注释
+//   .lib  RenLib 树形棋库: 20字节文件头，之后每个节点2字节 [位置, 标志]，按先序排列
+//         位置 = (col + 1) | (row << 4)，0 表示空着；标志 0x80 有子节点，0x40 有兄弟节点，
+//         0x08 / 0x20 后跟以 '\0' 结尾的注释，0x01 后跟4字节扩展数据。每条根到叶的路径导出为一盘棋。
+
+typedef enum {
+    FORMAT_UNKNOWN,
+    FORMAT_RECORD,
+    FORMAT_CORPUS,
+    FORMAT_PSQ,
+    FORMAT_POSLIST,
+    FORMAT_RENLIB
+} GameFormat;
+
+// 每读到一盘棋回调一次，返回0时停止导入
+typedef int (*GameSink)(void *user, const CorpusGame *game);
+
+// 按扩展名判断格式
+GameFormat formatFromPath(const char *path);
+
+// 从 fp 流式导入（FORMAT_CORPUS 需要 mmap，用 corpusOpen）
+// rule 用于不带规则信息的格式；越界或重复落子的对局会被跳过并计入 *rejected（可为 NULL）
+// 返回交给 sink 的盘数，格式错误时返回 -1
+long long importGames(FILE *fp, GameFormat format, RuleType rule, GameSink sink, void *user, long long *rejected);
+
+// 流式导出。RenLib 导出时相邻两盘的公共前缀共用树节点，输入按走法排序时可以得到完整合并的树；
+// 已写出的节点只需要回头补写标志，内存占用固定。
+typedef struct {
+    GameFormat format;
+    FILE *fp;
+    CorpusWriter corpus;
+    long long game_count;
+    // RenLib: 上一盘的走法及其各节点在文件中的位置
+    unsigned char last_moves[BOARD_SIZE * BOARD_SIZE];
+    long last_offsets[BOARD_SIZE * BOARD_SIZE];
+    unsigned char last_flags[BOARD_SIZE * BOARD_SIZE];
+    int last_count;
+} GameExporter;
+
+int exporterOpen(GameExporter *exporter, const char *path, GameFormat format);
+int exporterAdd(GameExporter *exporter, const CorpusGame *game);
+int exporterClose(GameExporter *exporter);
+
+// 把 in 中的所有对局转换到 out（格式均按扩展名识别），打印统计后返回1，失败返回0
+int convertGames(const char *in, const char *out, RuleType rule);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef LINETABLE_H
+#define LINETABLE_H
+
+#include "types.h"
+
+// 整线三进制查表评估
+// 一条长度为len的线共有 3^len 种状态（空/黑/白），对每种状态预先算好:
+//   [净分 (黑分 - 白分) | 黑方四数(3位) | 黑方活三数(3位)]
+// 打包方式与 evaluateLines2 的返回值一致，可以直接用 RESOLVE_SCORE 解出净分。
+// 表只覆盖长度 5..15 的线，共约 2150 万项（约 86 MB），由 gen_linetable 在构建期生成，运行时 mmap 只读映射。
+
+#define LINE_TABLE_MIN_LEN 5
+#define LINE_TABLE_MAGIC 0x544C4D47u // "GMLT"
+#define LINE_TABLE_VERSION 1
+
+// 默认表路径，可用环境变量 GOMOKU_LINETABLE 覆盖
+#ifndef LINE_TABLE_PATH
+#define LINE_TABLE_PATH "build/linetable.bin"
+#endif
+
+// 文件头（紧跟 int32 表项）
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int entry_count;
+    unsigned int offsets[BOARD_SIZE + 1]; // 各长度子表的起始项下标
+} LineTableHeader;
+
+// 各长度子表（未加载时为 NULL）
+extern const int *line_table[BOARD_SIZE + 1];
+
+// 二进制掩码 -> 三进制下标的拆分表（低8位 / 高7位）
+extern unsigned int line_tern_lo[256];
+extern unsigned int line_tern_hi[128];
+
+// 计算一条线在子表中的下标: sum(3^i * (b_i + 2 * w_i))
+static inline unsigned int lineTableIndex(Line b, Line w) {
+    unsigned int tb = line_tern_lo[b & 0xFF] + line_tern_hi[(b >> 8) & 0x7F];
+    unsigned int tw = line_tern_lo[w & 0xFF] + line_tern_hi[(w >> 8) & 0x7F];
+    return tb + 2 * tw;
+}
+
+// 查询一条线的打包分数，len 必须在 [5, 15]
+static inline int lineTableLookup(Line b, Line w, int len) {
+    return line_table[len][lineTableIndex(b, w)];
+}
+
+// 初始化三进制拆分表（生成器与加载器共用）
+void lineTableInitIndex(void);
+
+// 计算一条线的表项（生成器使用，与 evaluateLines2 的单线语义一致）
+int lineTableComputeEntry(Line b, Line w, int len);
+
+// 各长度子表的起始下标与总项数
+unsigned int lineTableOffset(int len);
+
+// mmap 加载表文件，path 为 NULL 时使用环境变量或默认路径
+// 返回1表示成功，0表示失败（表保持未加载）
+int lineTableLoad(const char *path);
+
+// 解除映射
+void lineTableFree(void);
+
+// 表是否可用
+int lineTableReady(void);
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "types.h"
+
+// Gomocup / Piskvork 引擎协议（stdin/stdout，每条命令一行）
+// 支持 START RESTART BEGIN TURN BOARD TAKEBACK INFO ABOUT END，坐标为 "x,y"（从0开始，x 为列，y 为行）。
+// INFO timeout_turn / timeout_match / time_left 决定每步的时间预算，max_memory 决定置换表大小，
+// rule 的第3位（4）表示连珠规则（对应 RULE_STANDARD），否则为无禁手。
+// 扩展的 INFO max_nodes 给出每步的节点预算（此时不再限时），供 gomoku-match 做可复现的对局。
+// 扩展的 INFO ponder 1 打开后台思考：回复走法后继续搜索对方要走的局面来预热置换表，收到下一条命令时停止。
+// 每完成一次迭代输出一行 "MESSAGE depth .. score .. nodes .. nps .. hashfull .. pv x,y ..."。
+// 对局状态与置换表在各回合之间保留。
+
+// 运行协议循环直到 END 或输入结束，rule 为收到 INFO rule 之前使用的规则
+int runGomocupProtocol(RuleType rule);
+
+#endif
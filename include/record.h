@@ -1,6 +1,7 @@
 #ifndef RECORD_H
 #define RECORD_H
 #include "types.h"
+#include <stdio.h>
 #include <time.h>
 
 //记录棋谱
@@ -9,4 +10,11 @@ int record(GameState* game);
 //导入固定格式的棋谱
 int load(GameState* game, char* filename);
 
+//把一局棋按棋谱格式写入 fp，name 写在 "file name:" 一栏
+int recordWrite(const GameState *game, FILE *fp, const char *name);
+
+//单遍读取 fp 中的一局棋谱（读到 "final chessboard:" 或文件尾为止），多局首尾相接时可以反复调用
+//moves 至少 225 项；读到一局返回1，文件已读完返回0
+int recordReadGame(FILE *fp, GameMode *mode, RuleType *rule, Position *moves, int *count);
+
 #endif
\ No newline at end of file
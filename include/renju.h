@@ -0,0 +1,84 @@
+#ifndef RENJU_H
+#define RENJU_H
+
+#include "types.h"
+
+// 基于位棋盘的黑方禁手检测（长连、四四、三三，活三的判定含递归禁手检查）
+// 判定规则与原先 rules.c 中逐格扫描的实现逐点一致，只是改为在4个方向的线位棋盘上用棋型掩码匹配。
+// board 只读；递归试下时在栈上的线副本里落子，不依赖全局状态，可以在多个搜索线程中并发调用。
+// 返回 0（非禁手）或 ERR_FORBIDDEN_33 / ERR_FORBIDDEN_44 / ERR_FORBIDDEN_OVERLINE
+int renjuForbidden(const BitBoardState *board, int row, int col);
+
+// 同 renjuForbidden（含 renjuMayBeForbidden 预筛），另外输出判定是否用到了4条线以外的棋子：
+// complex 为0时结果只取决于经过该点的4条线上前后5格内的棋子
+int renjuForbiddenDetail(const BitBoardState *board, int row, int col, int *complex);
+
+// --- 增量禁手位图 ---
+// 每次落子或提子后用 forbiddenMapTouch 把4条线上前后5格内的点标为待判断，
+// 需要时再用 forbiddenMapResolve / forbiddenMapTest 只重新判断这些点（以及 complex 点）。
+
+// 所有点标为待判断（首次调用时初始化 touch 掩码表，须在单线程中进行）
+void forbiddenMapInit(ForbiddenMap *map);
+
+// (row, col) 上落子或提子之后调用
+void forbiddenMapTouch(ForbiddenMap *map, int row, int col);
+
+// 重新判断 cells 中待判断的点，之后 map->forbidden 在 cells 内准确（已落子的点不会被标记）
+void forbiddenMapResolve(ForbiddenMap *map, const BitBoardState *board, Board256 cells);
+
+// 单点查询，必要时先重新判断该点；(row, col) 必须为空位
+int forbiddenMapTest(ForbiddenMap *map, const BitBoardState *board, int row, int col);
+
+// 生成候选落子点（同 generateMoves），map 不为 NULL 且 player 为黑方时去掉禁手点
+int renjuGenerateMoves(const BitBoardState *board, ForbiddenMap *map, Player player, Position *moves);
+
+// 线上 pos 前后各4格（共9格）内的黑子数，pos 处视为已落黑子（调用时 pos 为空位）
+static inline int renjuNearBlack(Line black, int pos) {
+    return __builtin_popcount((((unsigned int)black << 4) >> pos) & 0x1EF) + 1;
+}
+
+// 一个方向上可能构成棋型的窗口（pos 处视为已落黑子）：
+// 返回 2 表示有包含 pos、不含白子的5格窗口里有4颗黑子（四、长连的必要条件），
+// 返回 1 表示有与 isHuoThree 相同范围的不含白子的6格窗口里有3颗黑子（活三的必要条件）
+static inline int renjuLineReach(LinePair pair, int len, int pos) {
+    unsigned int black = pair.black | (1u << pos);
+    int reach = 0;
+    for (int s = pos - 4; s <= pos; s++) {
+        if (s < 0 || s + 5 > len || ((pair.white >> s) & 0x1F)) continue;
+        if (__builtin_popcount((black >> s) & 0x1F) >= 4) return 2;
+    }
+    for (int s = pos - 4; s < pos; s++) {
+        if (s < 0 || s + 6 > len || ((pair.white >> s) & 0x3F)) continue;
+        if (__builtin_popcount((black >> s) & 0x3F) >= 3) reach = 1;
+    }
+    return reach;
+}
+
+// 禁手的必要条件（快速预筛）：棋型都落在落子点前后4格内，
+// 长连与四至少要某个方向有4颗黑子，三三至少要两个方向各有3颗。
+// 先只数黑子，通过后再按不含白子的窗口细筛。
+// 返回0时一定不是禁手；返回1时需要 renjuForbidden 精确判断。(row, col) 必须为空位
+static inline int renjuMayBeForbidden(const BitBoardState *board, int row, int col) {
+    int d1 = row - col + BOARD_SIZE - 1, d2 = row + col;
+    int pos[4] = {row, col, (row < col) ? row : col, (row < BOARD_SIZE - 1 - col) ? row : BOARD_SIZE - 1 - col};
+    LinePair pairs[4] = {board->cols[col], board->rows[row], board->diag1[d1], board->diag2[d2]};
+    int near = 0;
+    for (int i = 0; i < 4; i++) {
+        int n = renjuNearBlack(pairs[i].black, pos[i]);
+        if (n >= 4) near += 2;
+        else if (n >= 3) near++;
+    }
+    if (near < 2) return 0;
+
+    int lens[4] = {BOARD_SIZE, BOARD_SIZE, BOARD_SIZE - ((d1 > 14) ? d1 - 14 : 14 - d1),
+                   BOARD_SIZE - ((d2 > 14) ? d2 - 14 : 14 - d2)};
+    int threes = 0;
+    for (int i = 0; i < 4; i++) {
+        int reach = renjuLineReach(pairs[i], lens[i], pos[i]);
+        if (reach == 2) return 1;
+        threes += reach;
+    }
+    return threes >= 2;
+}
+
+#endif
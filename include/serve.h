@@ -0,0 +1,57 @@
+#ifndef SERVE_H
+#define SERVE_H
+
+#include "types.h"
+
+// 本地分析服务（gomoku --serve）
+// 监听 Unix 套接字（地址 "unix:/path"）或只绑定本机的 HTTP（地址 "[127.0.0.1:]port"），
+// 请求由启动时就分配好置换表的一组引擎实例（每个工作线程一个 Engine）处理，所有实例共享一个只读的开局库。
+//
+// 请求是一个 JSON 对象（只支持一层，值为字符串、数字或 true/false）:
+//   "id"        任意字符串或数字，原样放回回复；编码成 JSON 后（含引号与转义）超过70个字符时回复 400
+//   "moves"     走法序列，如 "H8 I9 G9" 或 "h8i9g9"，轮到的一方由步数决定
+//   "board"     或者直接给出棋盘: 225 个字符，从第15行到第1行、每行从 A 到 O，'x' 黑 'o' 白 '.' 空（空白被忽略）
+//   "side"      与 "board" 一起使用: "black" / "white"，省略时双方子数相等为黑，否则为白
+//   "rule"      "std" / "simple"，省略时使用服务的默认规则
+//   "depth" "nodes" "movetime"(毫秒)  搜索限制，省略时使用服务的默认值；多主变时每条主变分别计算
+//   "multipv"   返回的候选走法数（1..SERVE_MAX_MULTIPV），第 k 条在排除前 k-1 条的根走法后重新搜索
+//   "book"      false 时不查开局库
+//   "clear"     true 时搜索前清空置换表（默认保留上一个请求留下的内容，同一请求的结果可能随之不同）
+//   "info"      true 时每完成一次迭代先发送一行 {"id":..,"info":{"line","depth","score","nodes","nps","hashfull","time_ms","pv":[..]}}
+//               （只用于 Unix 套接字）
+//   "cmd"       "stats" 时返回服务统计（也可以 GET /stats）；
+//               "stop" 时停止本连接上 id 等于 "target" 的请求（没有 target 时为全部），回复 {"stopped":n}：
+//               排队中的请求回复 "stopped"，正在搜索的在 1024 个节点内停下并回复已完成迭代的结果
+// 回复: {"id":..,"bestmove":"H8","score":..,"depth":..,"nodes":..,"time_ms":..,"queue_ms":..,
+//        "source":"search"|"book","lines":[{"move":..,"score":..,"depth":..,"nodes":..} 或 {"move":..,"count":..[,"decided":..,"wins":..]}]}
+// score 为轮到的一方的视角。出错时为 {"id":..,"error":"..."}。
+//
+// Unix 套接字上每行一个请求、每行一个回复，同一连接可以连续发送多个请求，回复按完成顺序返回（用 id 对应）；
+// HTTP 使用 POST /analyze（请求体为 JSON），支持 keep-alive，每个连接同时只处理一个请求。
+// 排队的请求按连接轮转分配给空闲的引擎（一个连接积压很多请求时不会挡住其他连接），
+// 排队总数超过 queue_limit 时直接回复 busy（HTTP 503），不让尾延迟无限增长。
+// Unix 套接字的连接断开时，它排队的请求被丢掉，正在搜索的请求立即停止。
+
+#define SERVE_MAX_MULTIPV 8
+
+typedef struct {
+    const char *address;          // "unix:/path" 或 "[host:]port"
+    int workers;                  // 引擎实例数，<=0 时为在线 CPU 数
+    int tt_mb;                    // 每个实例的置换表大小
+    int queue_limit;              // 排队请求上限
+    int max_depth;                // 请求未给出时的默认限制
+    unsigned long long max_nodes;
+    double max_time;
+    RuleType rule;                // 请求未给出规则时使用
+    char **book_paths;            // 开局库使用的棋谱文件
+    int book_count;
+    int book_ply;                 // 开局库收录的步数
+} ServeOptions;
+
+// 默认选项: 每个实例16MB置换表，深度8，排队上限1024，开局库收录前 BOOK_DEFAULT_PLY 步
+void serveDefaults(ServeOptions *options);
+
+// 运行服务直到收到 SIGINT / SIGTERM，正常退出返回1，无法监听或分配引擎时返回0
+int runServer(const ServeOptions *options);
+
+#endif
@@ -22,15 +22,30 @@ typedef struct {
     int32_t value;              
 } TTEntry;
 
-// 用size_mb MB初始化置换表
+// 一张置换表；交互对局使用全局默认表，批处理时每个线程各建一张
+typedef struct {
+    TTEntry* table;
+    uint64_t size; // 表项数量
+    uint64_t mask; // 用于快速索引的掩码（size - 1）
+} TranspositionTable;
+
+// 用size_mb MB初始化全局默认表
 void tt_init(int size_mb);
 
-// 释放置换表内存
+// 释放全局默认表内存
 void tt_free();
 
-// 清空置换表
+// 清空全局默认表
 void tt_clear();
 
+// 全局默认表（未初始化时 table 为 NULL）
+TranspositionTable* tt_default();
+
+// 新建 / 释放 / 清空一张独立的表
+TranspositionTable* tt_create(int size_mb);
+void tt_destroy(TranspositionTable* tt);
+void tt_reset(TranspositionTable* tt);
+
 // 查询置换表（TT）
 // 如果找到并且可用（基于深度/边界），返回1，否则返回0。
 // out_val: 从TT中获取的分数
@@ -40,12 +55,18 @@ void tt_clear();
 // tt_probe 现在接受alpha/beta的指针，可以根据TT中的边界收紧窗口。
 // 如果TT条目提供了更紧的边界，会更新*alpha和/或*beta，但不会强制剪枝。
 // 如果条目可直接返回分数（剪枝或精确），则返回1。
-int tt_probe(uint64_t key, int rem_depth, int* alpha, int* beta, int* out_val, Position* out_move);
+int tt_probe(TranspositionTable* tt, uint64_t key, int rem_depth, int* alpha, int* beta, int* out_val, Position* out_move);
 
 // 保存到置换表（TT）
-void tt_save(uint64_t key, int rem_depth, int value, int flag, Position best_move);
+void tt_save(TranspositionTable* tt, uint64_t key, int rem_depth, int value, int flag, Position best_move);
 
 // 预取TT条目
-void tt_prefetch(uint64_t key);
+void tt_prefetch(TranspositionTable* tt, uint64_t key);
+
+// 只取表项中的最佳走法（提取主变用），没有该局面时返回 (-1, -1)
+Position tt_best_move(const TranspositionTable* tt, uint64_t key);
+
+// 占用率（千分比），抽样前1000个表项
+int tt_hashfull(const TranspositionTable* tt);
 
 #endif 
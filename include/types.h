@@ -31,42 +31,63 @@ typedef struct {
 
 typedef unsigned short Line;
 
-// 每个玩家的88条不同基下的位棋盘表示
+// 同一条线上黑白双方的位棋盘相邻存放，一次32位加载即可取出一对
+typedef union {
+    struct {
+        Line black;
+        Line white;
+    };
+    Line side[2];      // 按 LINE_SIDE(player) 索引
+    unsigned int both; // [白 (高16位) | 黑 (低16位)]
+} LinePair;
+
+#define LINE_SIDE(player) ((player) == PLAYER_BLACK ? 0 : 1)
+
+// 整盘位棋盘: 15列 x 16位（位 = 行），每个64位字4列，运算见 board256.h
 typedef struct {
-    Line cols[BOARD_SIZE];          // (Index: col, Bit: row)
-    Line rows[BOARD_SIZE];          // (Index: row, Bit: col)
-    Line diag1[BOARD_SIZE * 2];     // (Index: row - col + 14, Bit: col)
-    Line diag2[BOARD_SIZE * 2];     // (Index: row + col, Bit: row)
-} PlayerBitBoard;
+    unsigned long long w[4];
+} Board256;
 
+// 双方88条不同基下的位棋盘表示
 typedef struct {
-    PlayerBitBoard black;
-    PlayerBitBoard white;
-    Line occupy[BOARD_SIZE];     // 0 = 已被占据(黑或白), 1 = 空
-    Line move_mask[BOARD_SIZE];  // 1 = 有效落子点(邻域), 0 = 无效
+    LinePair cols[BOARD_SIZE];      // (Index: col, Bit: row)
+    LinePair rows[BOARD_SIZE];      // (Index: row, Bit: col)
+    LinePair diag1[BOARD_SIZE * 2]; // (Index: row - col + 14, Bit: MIN(row, col))
+    LinePair diag2[BOARD_SIZE * 2]; // (Index: row + col, Bit: MIN(row, 14 - col))
+    Board256 stones[2];          // 双方的整盘位棋盘，按 LINE_SIDE(player) 索引
     unsigned long long hash;     // Zobrist Hash
 } BitBoardState;
 
-struct HistoryNode;
+// 黑方禁手点的增量位图，维护方式见 renju.h
+typedef struct {
+    Board256 forbidden; // 已判定为禁手的空位
+    Board256 dirty;     // 附近有落子或提子，需要重新判断的点
+    Board256 complex;   // 判定用到了4条线以外的棋子（关键点长连、递归活三），每次都要重新判断
+} ForbiddenMap;
+
+// 一步棋的撤销记录，悔棋时按记录做增量回退，不再保存整盘快照
+typedef struct {
+    signed char row, col;         // 落子位置
+    signed char prevRow, prevCol; // 落子前的 lastMove
+    signed char player;           // 落子方（调试模式下可能与轮次不符）
+} HistoryEntry;
 
+// 固定大小的走子历史，随 GameState 一起分配，落子和悔棋都不再 malloc
 typedef struct {
-    CellState board[BOARD_SIZE][BOARD_SIZE];
-    BitBoardState bitBoard; 
+    HistoryEntry moves[BOARD_SIZE * BOARD_SIZE];
+    int count; // 已落下的步数
+    int top;   // moves[count..top-1] 是悔掉的步，可以重做；新落子会清掉它们
+} GameHistory;
+
+typedef struct {
+    BitBoardState bitBoard;  // 唯一的棋盘表示，按格子查询用 getCell
+    ForbiddenMap forbidden;  // 标准规则下黑方的禁手点，makeMove 后已全部判定
     Player currentPlayer;
     Position lastMove;
     int moveCount;
     GameMode mode;
     RuleType ruleType;
-    struct HistoryNode* historyHead;
+    GameHistory history;
 } GameState;
 
-typedef struct HistoryNode {
-    CellState board[BOARD_SIZE][BOARD_SIZE];
-    BitBoardState bitBoard; 
-    Player currentPlayer;
-    Position lastMove;
-    int moveCount;
-    struct HistoryNode* next;
-} HistoryNode;
-
 #endif
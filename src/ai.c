@@ -3,17 +3,20 @@
 #include "../include/evaluate.h"
 #include "../include/tt.h"
 #include "../include/zobrist.h"
-#include "../include/ascii_art.h"
+#include "../include/linetable.h"
+#include "../include/renju.h"
 #include <string.h>
 #include <stdlib.h>
 #include<stdio.h>
+#include <time.h>
+#include <pthread.h>
 
 #define INF 100000000
-#define WIN_THRESHOLD 90000
 #define ABS(x) ((x) < 0 ? -(x) : (x))
 #define RESOLVE_SCORE(score) ((score) >> _SHIFT)
-#define RESOLVE_3(score) ((score) & ((BASE_4 - 1)))
-#define RESOLVE_4(score) (((score) & ((1 << (_SHIFT)) - BASE_4)) >> (_SHIFT / 2))
+
+// 每隔多少个节点检查一次预算
+#define BUDGET_CHECK_MASK 1023
 
 #define DIR_COL 0
 #define DIR_ROW 1
@@ -53,73 +56,99 @@ static inline int getLineLength(int dir, int idx) {
 //     return 0;
 // }
 
-// Helper: 初始化88条缓存和eval状态机
-static void initEvalState(const BitBoardState* board, EvalState* eval) {
-    eval->total_score = 0;
-    memset(eval->line_net_scores, 0, sizeof(eval->line_net_scores));
-    memset(eval->count_live3, 0, sizeof(eval->count_live3));
-    memset(eval->count_4, 0, sizeof(eval->count_4));
-
-
-    // 1. 列与行
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        // Cols
-        Line b = board->black.cols[i];
-        Line w = board->white.cols[i];
-        unsigned long long scores = evaluateLines2(b, w, BOARD_SIZE, w, b, BOARD_SIZE);
-        int b_score = RESOLVE_SCORE((int)scores);
-        int w_score = RESOLVE_SCORE((int)(scores >> 32));
-        int score = b_score - w_score;
-        eval->line_net_scores[DIR_COL][i] = score;
-        eval->count_live3[DIR_COL][i] = RESOLVE_3((int)scores);
-        eval->count_4[DIR_COL][i] = RESOLVE_4((int)scores);
-        eval->total_score += score;
-
-        // Rows
-        b = board->black.rows[i];
-        w = board->white.rows[i];
-        scores = evaluateLines2(b, w, BOARD_SIZE, w, b, BOARD_SIZE);
-        b_score = RESOLVE_SCORE((int)scores);
-        w_score = RESOLVE_SCORE((int)(scores >> 32));
-        score = b_score - w_score;
-        eval->line_net_scores[DIR_ROW][i] = score;
-        eval->count_live3[DIR_ROW][i] = RESOLVE_3((int)scores);
-        eval->count_4[DIR_ROW][i] = RESOLVE_4((int)scores);
-        eval->total_score += score;
+// Helper: 黑方在 (row, col) 落子是否为禁手（该点须为空位），结果由增量禁手位图缓存
+static inline int searchForbidden(SearchContext* ctx, int row, int col) {
+    if (ctx->rule != RULE_STANDARD) return 0;
+    return forbiddenMapTest(&ctx->forbidden, &ctx->board, row, col);
+}
+
+// Helper: 生成走法，标准规则下黑方不生成禁手点
+static inline int generateSearchMoves(SearchContext* ctx, Player player, Position* moves) {
+    return renjuGenerateMoves(&ctx->board, (ctx->rule == RULE_STANDARD) ? &ctx->forbidden : NULL, player, moves);
+}
+
+// Helper: 落子或提子后标记受影响的禁手点
+static inline void touchForbidden(SearchContext* ctx, int row, int col) {
+    if (ctx->rule == RULE_STANDARD) forbiddenMapTouch(&ctx->forbidden, row, col);
+}
+
+// Helper: 评估经过落子点的4条线
+// 输出各方向的净分（黑分-白分），长度不足5的对角线不输出
+static inline void evaluateMoveLines(const BitBoardState* board, int row, int col, const int* indices, const int* lens,
+                                     int* nets) {
+#if EVAL_BACKEND == EVAL_BACKEND_TABLE
+    // 查表后端：每条线一次查表，表未加载时退回 evaluateLines4
+    if (lineTableReady()) {
+        LinePair pairs[4] = {board->cols[col], board->rows[row], board->diag1[indices[2]], board->diag2[indices[3]]};
+        for (int i = 0; i < 4; i++) {
+            if (lens[i] < 5) continue;
+            nets[i] = RESOLVE_SCORE(lineTableLookup(pairs[i].black, pairs[i].white, lens[i]));
+        }
+        return;
     }
+#endif
+
+    // 使用 evaluateLines4 计算新的分数
+    Lines4 b_lines, w_lines, masks;
+
+    // 打包各方向的棋型: [Diag2 | Diag1 | Row | Col]
+    // 低位: [Row (32-63) | Col (0-31)]
+    // 高位: [Diag2 (32-63) | Diag1 (0-31)]
+    // 每个 LinePair 是 [白 | 黑] 两个16位，两对拼成64位后黑白各占隔开的16位，一次掩码即可分离
+    #define PAIR_BLACK 0x0000FFFF0000FFFFULL
+
+    // Col / Row
+    unsigned long long low = (unsigned long long)board->cols[col].both | ((unsigned long long)board->rows[row].both << 32);
+    b_lines.low = low & PAIR_BLACK;
+    w_lines.low = (low >> 16) & PAIR_BLACK;
+    masks.low = ((1ULL << lens[0]) - 1) | (((1ULL << lens[1]) - 1) << 32);
 
-    // 2. 对角线
-    for (int i = 0; i < (BOARD_SIZE * 2 - 1); i++) {
-        int len = getLineLength(DIR_DIAG1, i);
-        if (len < 5) continue;
-
-        // Diag1
-        Line b = board->black.diag1[i];
-        Line w = board->white.diag1[i];
-        unsigned long long scores = evaluateLines2(b, w, len, w, b, len);
-        int b_score = RESOLVE_SCORE((int)scores);
-        int w_score = RESOLVE_SCORE((int)(scores >> 32));
-        int score = b_score - w_score;
-        eval->line_net_scores[DIR_DIAG1][i] = score;
-        eval->count_live3[DIR_DIAG1][i] = RESOLVE_3((int)scores);
-        eval->count_4[DIR_DIAG1][i] = RESOLVE_4((int)scores);
-        eval->total_score += score;
-
-        // Diag2
-        b = board->black.diag2[i];
-        w = board->white.diag2[i];
-        scores = evaluateLines2(b, w, len, w, b, len);
-        b_score = RESOLVE_SCORE((int)scores);
-        w_score = RESOLVE_SCORE((int)(scores >> 32));
-        score = b_score - w_score;
-        eval->line_net_scores[DIR_DIAG2][i] = score;
-        eval->count_live3[DIR_DIAG2][i] = RESOLVE_3((int)scores);
-        eval->count_4[DIR_DIAG2][i] = RESOLVE_4((int)scores);
-        eval->total_score += score;
+    // Diag1 / Diag2，长度不足5的对角线置0
+    unsigned long long d1 = (lens[2] >= 5) ? board->diag1[indices[2]].both : 0;
+    unsigned long long d2 = (lens[3] >= 5) ? board->diag2[indices[3]].both : 0;
+    unsigned long long high = d1 | (d2 << 32);
+    b_lines.high = high & PAIR_BLACK;
+    w_lines.high = (high >> 16) & PAIR_BLACK;
+    masks.high = ((lens[2] >= 5) ? (1ULL << lens[2]) - 1 : 0) | ((lens[3] >= 5) ? ((1ULL << lens[3]) - 1) << 32 : 0);
+
+    #undef PAIR_BLACK
+
+    DualLines scores = evaluateLines4(b_lines, w_lines, masks);
+
+    // 解包: [col, row, diag1, diag2]
+    unsigned long long b_scores[4] = {scores.me.low & 0xFFFFFFFF, scores.me.low >> 32,
+                                      scores.me.high & 0xFFFFFFFF, scores.me.high >> 32};
+    unsigned long long w_scores[4] = {scores.enemy.low & 0xFFFFFFFF, scores.enemy.low >> 32,
+                                      scores.enemy.high & 0xFFFFFFFF, scores.enemy.high >> 32};
+    for (int i = 0; i < 4; i++) {
+        nets[i] = (int)RESOLVE_SCORE(b_scores[i]) - (int)RESOLVE_SCORE(w_scores[i]);
     }
 }
 
-static void aiMakeMove(BitBoardState* board, EvalState* eval, int row, int col, Player player, UndoInfo* undo) {
+#if EVAL_BACKEND == EVAL_BACKEND_WINDOW
+// 走法来自 generateSearchMoves，黑方不会走到禁手点
+void aiMakeMove(SearchContext* ctx, int row, int col, Player player, UndoInfo* undo) {
+    undo->old_total_score = ctx->eval.total_score;
+
+    // 更新棋盘
+    updateBitBoard(&ctx->board, row, col, player);
+    touchForbidden(ctx, row, col);
+
+    // 窗口评估直接给出总分变化
+    ctx->eval.total_score += evaluateWindowDelta(&ctx->board, row, col);
+}
+
+void aiUnmakeMove(SearchContext* ctx, int row, int col, Player player, const UndoInfo* undo) {
+    undoBitBoard(&ctx->board, row, col, player);
+    touchForbidden(ctx, row, col);
+    ctx->eval.total_score = undo->old_total_score;
+}
+#else
+// 走法来自 generateSearchMoves，黑方不会走到禁手点
+void aiMakeMove(SearchContext* ctx, int row, int col, Player player, UndoInfo* undo) {
+    BitBoardState* board = &ctx->board;
+    EvalState* eval = &ctx->eval;
+
     // 计算各个方向的索引
     int indices[4];
     indices[0] = col;
@@ -131,138 +160,32 @@ static void aiMakeMove(BitBoardState* board, EvalState* eval, int row, int col,
     undo->old_total_score = eval->total_score;
     for(int i=0; i<4; i++) {
         undo->old_line_net_scores[i] = eval->line_net_scores[i][indices[i]];
-        undo->old_count_live3[i] = eval->count_live3[i][indices[i]];
-        undo->old_count_4[i] = eval->count_4[i][indices[i]];
         eval->total_score -= undo->old_line_net_scores[i];
     }
 
     // 更新棋盘
-    updateBitBoard(board, row, col, player, undo->move_mask_backup);
+    updateBitBoard(board, row, col, player);
+    touchForbidden(ctx, row, col);
 
-    // 使用 evaluateLines4 计算新的分数
-    Lines4 b_lines, w_lines, masks;
     int lens[4];
     for(int i=0; i<4; i++) lens[i] = getLineLength(i, indices[i]);
 
-    // 打包各方向的棋型: [Diag2 | Diag1 | Row | Col]
-    // 低位: [Row (32-63) | Col (0-31)]
-    // 高位: [Diag2 (32-63) | Diag1 (0-31)]
-    
-    // Col
-    b_lines.low = (unsigned long long)board->black.cols[col];
-    w_lines.low = (unsigned long long)board->white.cols[col];
-    masks.low = (1ULL << lens[0]) - 1;
-
-    // Row
-    b_lines.low |= ((unsigned long long)board->black.rows[row] << 32);
-    w_lines.low |= ((unsigned long long)board->white.rows[row] << 32);
-    masks.low |= (((1ULL << lens[1]) - 1) << 32);
-
-    // Diag1
-    if (lens[2] >= 5) {
-        b_lines.high = (unsigned long long)board->black.diag1[indices[2]];
-        w_lines.high = (unsigned long long)board->white.diag1[indices[2]];
-        masks.high = (1ULL << lens[2]) - 1;
-    } else {
-        b_lines.high = 0; w_lines.high = 0; masks.high = 0;
-    }
+    int nets[4];
+    evaluateMoveLines(board, row, col, indices, lens, nets);
 
-    // Diag2
-    if (lens[3] >= 5) {
-        b_lines.high |= ((unsigned long long)board->black.diag2[indices[3]] << 32);
-        w_lines.high |= ((unsigned long long)board->white.diag2[indices[3]] << 32);
-        masks.high |= (((1ULL << lens[3]) - 1) << 32);
-    }
-
-    DualLines scores = evaluateLines4(b_lines, w_lines, masks);
-    Lines4 b_scores = scores.me;
-    Lines4 w_scores = scores.enemy;
-
-    // 解包并更新
-    // col
-    int b_score = RESOLVE_SCORE(b_scores.low & 0xFFFFFFFF);
-    int w_score = RESOLVE_SCORE(w_scores.low & 0xFFFFFFFF);
-    int col_live3 = RESOLVE_3(b_scores.low & 0xFFFFFFFF);
-    int col_4 = RESOLVE_4(b_scores.low & 0xFFFFFFFF);
-
-    eval->line_net_scores[DIR_COL][col] = b_score - w_score;
-    eval->count_live3[DIR_COL][col] = col_live3;
-    eval->count_4[DIR_COL][col] = col_4;
-    eval->total_score += eval->line_net_scores[DIR_COL][col];
-
-    // row
-    b_score = RESOLVE_SCORE(b_scores.low >> 32);
-    w_score = RESOLVE_SCORE(w_scores.low >> 32);
-    int row_live3 = RESOLVE_3(b_scores.low >> 32);
-    int row_4 = RESOLVE_4(b_scores.low >> 32);
-    
-    eval->line_net_scores[DIR_ROW][row] = b_score - w_score;
-    eval->count_live3[DIR_ROW][row] = row_live3;
-    eval->count_4[DIR_ROW][row] = row_4;
-    eval->total_score += eval->line_net_scores[DIR_ROW][row];
-
-    // diag1
-    if (lens[2] >= 5) {
-        b_score = RESOLVE_SCORE(b_scores.high & 0xFFFFFFFF);
-        w_score = RESOLVE_SCORE(w_scores.high & 0xFFFFFFFF);
-        int diag1_live3 = RESOLVE_3(b_scores.high & 0xFFFFFFFF);
-        int diag1_4 = RESOLVE_4(b_scores.high & 0xFFFFFFFF);
-        
-        eval->line_net_scores[DIR_DIAG1][indices[2]] = b_score - w_score;
-        eval->count_live3[DIR_DIAG1][indices[2]] = diag1_live3;
-        eval->count_4[DIR_DIAG1][indices[2]] = diag1_4;
-        eval->total_score += eval->line_net_scores[DIR_DIAG1][indices[2]];
-    }
-
-    // diag2
-    if (lens[3] >= 5) {
-        b_score = RESOLVE_SCORE(b_scores.high >> 32);
-        w_score = RESOLVE_SCORE(w_scores.high >> 32);
-        int diag2_live3 = RESOLVE_3(b_scores.high >> 32);
-        int diag2_4 = RESOLVE_4(b_scores.high >> 32);
-        
-        eval->line_net_scores[DIR_DIAG2][indices[3]] = b_score - w_score;
-        eval->count_live3[DIR_DIAG2][indices[3]] = diag2_live3;
-        eval->count_4[DIR_DIAG2][indices[3]] = diag2_4;
-        eval->total_score += eval->line_net_scores[DIR_DIAG2][indices[3]];
-    }
-
-    // 禁手判断（仅对黑棋）
-    if (player == PLAYER_BLACK) {
-        int new_live3_count = 0;
-        int new_4_count = 0;
-        
-        // 计算新产生的活三和四的总数
-        for (int i = 0; i < 4; i++) {
-            int idx = indices[i];
-            // 跳过长度不足5的对角线
-            if ((i == 2 || i == 3) && lens[i] < 5) continue;
-            
-            // 新产生的数量 = 当前数量 - 旧数量
-            int diff_3 = eval->count_live3[i][idx] - undo->old_count_live3[i];
-            int diff_4 = eval->count_4[i][idx] - undo->old_count_4[i];
-            
-            if (diff_3 > 0) new_live3_count += diff_3;
-            if (diff_4 > 0) new_4_count += diff_4;
-            
-            // 调试可能的禁手
-            // if (diff_3 > 0 || diff_4 > 0) {
-            //    printf("Move (%d, %d) Dir %d: +Live3=%d, +Four=%d\n", row, col, i, diff_3, diff_4);
-            // }
-        }
-        
-        if (new_live3_count >= 2 || new_4_count >= 2) {
-            // printf("检测到禁手 (%d, %d): Live3=%d, Four=%d\n", row, col, new_live3_count, new_4_count);
-            eval->total_score = -INF;
-        }
+    // 更新缓存，跳过长度不足5的对角线
+    for (int i = 0; i < 4; i++) {
+        if (lens[i] < 5) continue;
+        eval->line_net_scores[i][indices[i]] = nets[i];
+        eval->total_score += nets[i];
     }
-
 }
 
-static void aiUnmakeMove(BitBoardState* board, EvalState* eval, int row, int col, Player player, const UndoInfo* undo) {
-    undoBitBoard(board, row, col, player, undo->move_mask_backup);
+void aiUnmakeMove(SearchContext* ctx, int row, int col, Player player, const UndoInfo* undo) {
+    undoBitBoard(&ctx->board, row, col, player);
+    touchForbidden(ctx, row, col);
 
-    eval->total_score = undo->old_total_score;
+    ctx->eval.total_score = undo->old_total_score;
     
     int indices[4];
     indices[0] = col;
@@ -271,21 +194,20 @@ static void aiUnmakeMove(BitBoardState* board, EvalState* eval, int row, int col
     indices[3] = row + col;
 
     for(int i=0; i<4; i++) {
-        eval->line_net_scores[i][indices[i]] = undo->old_line_net_scores[i];
-        eval->count_live3[i][indices[i]] = undo->old_count_live3[i];
-        eval->count_4[i][indices[i]] = undo->old_count_4[i];
+        ctx->eval.line_net_scores[i][indices[i]] = undo->old_line_net_scores[i];
     }
 }
-
-    // 前置声明
-static void aiMakeMove(BitBoardState* board, EvalState* eval, int row, int col, Player player, UndoInfo* undo);
-static void aiUnmakeMove(BitBoardState* board, EvalState* eval, int row, int col, Player player, const UndoInfo* undo);
+#endif
 
 // Helper: 维护一个sort列表
-// Order: Hash Move > Killer Moves > MyScore
+// Order: Hash Move > Killer Moves > MyScore + (对方在该点的得分 >> ORDER_DEFENCE_SHIFT)
 static inline int sortMoves(SearchContext* ctx, Position* moves, Position* sorted_moves, Position tt_move, int count, int depth, Player player) {
     int scores[BEAM_WIDTH + 1]; // 缓存分数，避免重复计算
     int sorted_count = 0;
+
+    // 一次批量评估所有候选点，不再逐个 make/unmake
+    CandidateScore candidates[BOARD_SIZE * BOARD_SIZE];
+    evaluateCandidates(&ctx->board, &ctx->eval, moves, count, player, candidates);
    
     for (int i = 0; i < count; i++) {
         // 1. 计算当前走法的分数
@@ -297,13 +219,16 @@ static inline int sortMoves(SearchContext* ctx, Position* moves, Position* sorte
             (moves[i].row == ctx->killer_moves[depth][1].row && moves[i].col == ctx->killer_moves[depth][1].col)) {
             score = INF; // 杀手走法优先级次高
         } else {
-            UndoInfo undo;
-            
-            // 评估我的走法
-            aiMakeMove(&ctx->board, &ctx->eval, moves[i].row, moves[i].col, player, &undo);
-            score = (player == PLAYER_BLACK) ? ctx->eval.total_score : -ctx->eval.total_score;
-            aiUnmakeMove(&ctx->board, &ctx->eval, moves[i].row, moves[i].col, player, &undo);
-
+            // 进攻分 + 按比例计入堵住对方的收益
+            score = candidates[i].attack + (candidates[i].defence >> ORDER_DEFENCE_SHIFT);
+
+            // 黑方无法落子的禁手点白方不需要防守（黑方的走法已去掉禁手点）
+            // 去掉防守分只会让分数变低，所以只有能进入排序列表的点才需要判断
+            int may_enter = sorted_count < BEAM_WIDTH || score > scores[BEAM_WIDTH - 1];
+            if (may_enter && player == PLAYER_WHITE && candidates[i].defence > 0 &&
+                searchForbidden(ctx, moves[i].row, moves[i].col)) {
+                score = candidates[i].attack;
+            }
         }
 
         // 2. 插入排序列表
@@ -327,8 +252,29 @@ static inline int sortMoves(SearchContext* ctx, Position* moves, Position* sorte
     return sorted_count;// 返回 min(BEAM_WIDTH, count)
 }
 
+static double searchClock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 节点或时间预算是否已经用完（只在每 BUDGET_CHECK_MASK + 1 个节点时真正检查）
+static inline int budgetExhausted(SearchContext* ctx) {
+    if (ctx->stopped) return 1;
+    if ((ctx->nodes_searched & BUDGET_CHECK_MASK) != 0) return 0;
+    if ((ctx->max_nodes && ctx->nodes_searched >= ctx->max_nodes) ||
+        (ctx->deadline > 0 && searchClock() >= ctx->deadline) ||
+        (ctx->stop_flag && atomic_load_explicit(ctx->stop_flag, memory_order_relaxed))) {
+        ctx->stopped = 1;
+    }
+    return ctx->stopped;
+}
+
 // 搜索函数，返回best_score（我）或者worst_score（对方）
+// 预算用完时返回值无意义，调用方应检查 ctx->stopped
 static int alphaBeta(SearchContext* ctx, int depth, int max_depth, int alpha, int beta, Player player) {
+    if ((ctx->max_nodes || ctx->deadline > 0 || ctx->stop_flag) && budgetExhausted(ctx)) return 0;
+
     // 置换表查询
     int rem_depth = max_depth - depth;
     int tt_val;
@@ -336,7 +282,7 @@ static int alphaBeta(SearchContext* ctx, int depth, int max_depth, int alpha, in
     
     int _loc_alpha = alpha;
     int _loc_beta = beta;
-    if (tt_probe(ctx->board.hash, rem_depth, &_loc_alpha, &_loc_beta, &tt_val, &tt_move)) {
+    if (tt_probe(ctx->tt, ctx->board.hash, rem_depth, &_loc_alpha, &_loc_beta, &tt_val, &tt_move)) {
         return scoreFromTT(tt_val, depth);
     }
     alpha = _loc_alpha;
@@ -354,7 +300,7 @@ static int alphaBeta(SearchContext* ctx, int depth, int max_depth, int alpha, in
 
     // 生成走法
     Position moves[225];
-    int count = generateMoves(&ctx->board, moves);
+    int count = generateSearchMoves(ctx, player, moves);
     if (count == 0) return 0; // 平局
 
     // 排序走法
@@ -368,7 +314,7 @@ static int alphaBeta(SearchContext* ctx, int depth, int max_depth, int alpha, in
 
     for (int i = 0; i < limit; i++) {
         UndoInfo undo;
-        aiMakeMove(&ctx->board, &ctx->eval, sorted_moves[i].row, sorted_moves[i].col, player, &undo);
+        aiMakeMove(ctx, sorted_moves[i].row, sorted_moves[i].col, player, &undo);
         ctx->nodes_searched++;
 
         int score;
@@ -385,7 +331,8 @@ static int alphaBeta(SearchContext* ctx, int depth, int max_depth, int alpha, in
             }
         }
 
-        aiUnmakeMove(&ctx->board, &ctx->eval, sorted_moves[i].row, sorted_moves[i].col, player, &undo);
+        aiUnmakeMove(ctx, sorted_moves[i].row, sorted_moves[i].col, player, &undo);
+        if (ctx->stopped) return 0;
 
         if (score > best_score) {
             best_score = score;
@@ -413,46 +360,129 @@ static int alphaBeta(SearchContext* ctx, int depth, int max_depth, int alpha, in
         flag = TT_FLAG_LOWERBOUND;
     }
     
-    tt_save(ctx->board.hash, rem_depth, scoreToTT(best_score, depth), flag, best_move);
+    tt_save(ctx->tt, ctx->board.hash, rem_depth, scoreToTT(best_score, depth), flag, best_move);
 
     return best_score;
 }
 
-Position getAIMove(const GameState *game) {
-    if(game->moveCount == 0) {
-        // 如果是第一步，落子在棋盘中心
-        return (Position){BOARD_SIZE / 2, BOARD_SIZE / 2};
+// 初始化全局表（Zobrist、评估内核，以及查表后端的评分表）
+// 全局默认置换表等到第一次用到时才分配，自带置换表的调用方（批处理、协议模式）不必多占内存
+// 只读全局表的一次性初始化
+static void aiInitOnce(void) {
+    ForbiddenMap warm;
+    initZobrist();
+    evaluateGetKernel(); // 尚未选择评估内核时现在选择，避免多个线程首次评估时同时选择
+    forbiddenMapInit(&warm); // 禁手位图的 touch 掩码表
+#if EVAL_BACKEND == EVAL_BACKEND_TABLE
+    if (!lineTableLoad(NULL)) {
+        fprintf(stderr, "line table unavailable, falling back to evaluateLines4\n");
     }
+#endif
+}
+
+void aiInit(void) {
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, aiInitOnce);
+}
+
+void aiContextInit(SearchContext* ctx, const GameState* game, TranspositionTable* tt) {
+    // 初始化置换表（需在计算根节点哈希之前完成）
+    aiInit();
 
     //初始化eval
-    SearchContext ctx;
-    memset(&ctx, 0, sizeof(SearchContext));
-    ctx.board = game->bitBoard;
-    initEvalState(&ctx.board, &ctx.eval);
-    Player me = game->currentPlayer;
-    if (ctx.board.hash == 0) {
-        ctx.board.hash = calculateZobristHash(&ctx.board, me);
+    memset(ctx, 0, sizeof(SearchContext));
+    ctx->board = game->bitBoard;
+    ctx->rule = game->ruleType;
+    ctx->forbidden = game->forbidden;
+    if (tt) {
+        ctx->tt = tt;
+    } else {
+        if (!tt_default()->table) tt_init(64); // 64MB
+        ctx->tt = tt_default();
     }
+    scanBoard(&ctx->board, &ctx->eval);
+    ctx->board.hash = calculateZobristHash(&ctx->board, game->currentPlayer);
+}
 
-    // 初始化置换表
-    static int tt_initialized = 0;
-    if (!tt_initialized) {
-        initZobrist();
-        tt_init(64); // 64MB
-        tt_initialized = 1;
+// 完成一次迭代后报告进度：主变从最佳根走法开始，沿置换表中的最佳走法展开，遇到空项或已占用的点为止
+static void reportIteration(const SearchContext* ctx, const SearchControl* control, Player me, int depth, int score,
+                            Position best_move, double elapsed) {
+    SearchInfo info;
+    BitBoardState board = ctx->board;
+    Player player = me;
+    Position move = best_move;
+    info.depth = depth;
+    info.score = score;
+    info.pv_length = 0;
+    while (move.row >= 0 && info.pv_length < depth && info.pv_length < MAX_DEPTH &&
+           !board256Test(&board.stones[0], move.row, move.col) && !board256Test(&board.stones[1], move.row, move.col)) {
+        info.pv[info.pv_length++] = move;
+        updateBitBoard(&board, move.row, move.col, player);
+        player = (player == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK;
+        move = tt_best_move(ctx->tt, board.hash);
     }
-    
+    info.nodes = ctx->nodes_searched;
+    info.time = elapsed;
+    info.nps = elapsed > 0 ? ctx->nodes_searched / elapsed : 0;
+    info.hashfull = tt_hashfull(ctx->tt);
+    control->on_info(&info, control->user);
+}
+
+Position aiSearch(const GameState *game, const SearchLimits *limits, SearchResult *result) {
+    return aiSearchControlled(game, limits, NULL, result);
+}
+
+Position aiSearchControlled(const GameState *game, const SearchLimits *limits, const SearchControl *control,
+                            SearchResult *result) {
+    SearchResult local_result;
+    if (!result) result = &local_result;
+    result->best_move = INVALID_POS;
+    result->score = 0;
+    result->depth = 0;
+    result->nodes = 0;
+    result->iteration_count = 0;
+
+    if(game->moveCount == 0) {
+        // 如果是第一步，落子在棋盘中心（被排除时没有别的候选点）
+        if (limits && limits->exclude_count > 0) return result->best_move;
+        result->best_move = (Position){BOARD_SIZE / 2, BOARD_SIZE / 2};
+        return result->best_move;
+    }
+
+    SearchContext ctx;
+    aiContextInit(&ctx, game, limits ? limits->tt : NULL);
+    ctx.max_nodes = limits ? limits->max_nodes : 0;
+    ctx.stop_flag = control ? control->stop : NULL;
+    double start = searchClock();
+    ctx.deadline = (limits && limits->max_time > 0) ? start + limits->max_time : 0;
+    Player me = game->currentPlayer;
+
+    int max_depth = (limits && limits->max_depth > 0) ? limits->max_depth : SEARCH_DEPTH;
+    if (max_depth > SEARCH_DEPTH) max_depth = SEARCH_DEPTH;
+    int verbose = limits ? limits->verbose : 0;
 
     //迭代加深搜索
     Position moves[225];
-    int count = generateMoves(&ctx.board, moves);
-    // if (count == 0) return (Position){7, 7}; // 理论上不会发生
+    // 黑方的禁手点不会生成，返回的走法一定合法
+    int count = generateSearchMoves(&ctx, me, moves);
+    if (limits && limits->exclude_count > 0) {
+        int kept = 0;
+        for (int i = 0; i < count; i++) {
+            int excluded = 0;
+            for (int k = 0; k < limits->exclude_count; k++) {
+                if (moves[i].row == limits->exclude[k].row && moves[i].col == limits->exclude[k].col) excluded = 1;
+            }
+            if (!excluded) moves[kept++] = moves[i];
+        }
+        count = kept;
+    }
+    if (count == 0) return result->best_move; // 没有可走的点
 
     Position best_move = moves[0];
     int best_score = -INF;
     UndoInfo undo;
     
-    for (int depth = 2; depth <= SEARCH_DEPTH; depth += 2) {
+    for (int depth = 2; depth <= max_depth; depth += 2) {
         // 对根节点走法排序
         Position sorted_moves[BEAM_WIDTH + 1] = {0};
         int limit;
@@ -462,7 +492,7 @@ Position getAIMove(const GameState *game) {
         Position tt_root_move = INVALID_POS;
         {
             int _ra = -INF, _rb = INF;
-            tt_probe(ctx.board.hash, depth, &_ra, &_rb, &tt_val, &tt_root_move);
+            tt_probe(ctx.tt, ctx.board.hash, depth, &_ra, &_rb, &tt_val, &tt_root_move);
         }
 
         // 走法排序：将置换表中的最佳走法放在首位
@@ -474,18 +504,19 @@ Position getAIMove(const GameState *game) {
         int beta = INF;
         
         for (int i = 0; i < limit; i++) {
-            aiMakeMove(&ctx.board, &ctx.eval, sorted_moves[i].row, sorted_moves[i].col, me, &undo);
-            
-            // 检查走法是否为禁手（仅对黑棋）
-            if (me == PLAYER_BLACK && ctx.eval.total_score == -INF) {
-                 // printf("根节点走法 (%d, %d) 是禁手，跳过。\n", sorted_moves[i].row, sorted_moves[i].col);
-                 aiUnmakeMove(&ctx.board, &ctx.eval, sorted_moves[i].row, sorted_moves[i].col, me, &undo);
-                 continue;
-            }
+            aiMakeMove(&ctx, sorted_moves[i].row, sorted_moves[i].col, me, &undo);
+
             // 检查根节点是否直接获胜
             int current_val = (me == PLAYER_BLACK) ? ctx.eval.total_score : -ctx.eval.total_score;
             if(current_val >= WIN_THRESHOLD){
-                aiUnmakeMove(&ctx.board, &ctx.eval, sorted_moves[i].row, sorted_moves[i].col, me, &undo);
+                aiUnmakeMove(&ctx, sorted_moves[i].row, sorted_moves[i].col, me, &undo);
+                result->best_move = sorted_moves[i];
+                result->score = current_val;
+                result->depth = depth;
+                result->nodes = ctx.nodes_searched;
+                if (control && control->on_info) {
+                    reportIteration(&ctx, control, me, depth, current_val, sorted_moves[i], searchClock() - start);
+                }
                 return sorted_moves[i];
             }
 
@@ -493,7 +524,8 @@ Position getAIMove(const GameState *game) {
 
             int score = -alphaBeta(&ctx, 1, depth, -beta, -alpha, (me == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK);
 
-            aiUnmakeMove(&ctx.board, &ctx.eval, sorted_moves[i].row, sorted_moves[i].col, me, &undo);
+            aiUnmakeMove(&ctx, sorted_moves[i].row, sorted_moves[i].col, me, &undo);
+            if (ctx.stopped) break;
 
             if (score > current_best_score) {
                 current_best_score = score;
@@ -505,17 +537,40 @@ Position getAIMove(const GameState *game) {
             }
         }
         
+        // 预算用完：丢弃这一层没搜完的结果，一层都没完成时才采用
+        if (ctx.stopped) {
+            if (result->depth == 0 && current_best_score > -INF) {
+                best_score = current_best_score;
+                best_move = current_best_move;
+            }
+            break;
+        }
+
         // 如果更深层搜索结果极低（被迫输），则不更新 best_move / best_score。
         // 这样可以避免ai在对方棋力不如自己的时候开摆
         if (current_best_score > -WIN_THRESHOLD) {
             best_score = current_best_score;
             best_move = current_best_move;  
         } 
-        printf("Depth %d: Best Move (%d, %d), Score %d\nMove List:", depth, best_move.row, best_move.col, best_score);
-        for(int i = 0; i < limit; i++){
-            printf("(%d, %d) ", sorted_moves[i].row, sorted_moves[i].col);
+        result->depth = depth;
+        if (result->iteration_count < MAX_ITERATIONS) {
+            SearchIteration *it = &result->iterations[result->iteration_count++];
+            it->depth = depth;
+            it->score = best_score;
+            it->best_move = best_move;
+            it->nodes = ctx.nodes_searched;
+            it->time = searchClock() - start;
+        }
+        if (control && control->on_info) {
+            reportIteration(&ctx, control, me, depth, best_score, best_move, searchClock() - start);
+        }
+        if (verbose) {
+            printf("Depth %d: Best Move (%d, %d), Score %d\nMove List:", depth, best_move.row, best_move.col, best_score);
+            for(int i = 0; i < limit; i++){
+                printf("(%d, %d) ", sorted_moves[i].row, sorted_moves[i].col);
+            }
+            printf("\n");
         }
-        printf("\n");
         //有胜手了就提前退出第0层搜索
         if (best_score > WIN_THRESHOLD) break;
     }
@@ -574,14 +629,8 @@ Position getAIMove(const GameState *game) {
     //         (int)ctx.eval.count_4[i][(i==0)?best_move.col:((i==1)?best_move.row:((i==2)?(best_move.row-best_move.col+BOARD_SIZE-1):(best_move.row+best_move.col)))]);
     // }
     // aiUnmakeMove(&ctx.board, &ctx.eval, best_move.row, best_move.col, me, &undo);
-    // Set ascii face flag according to final best_score
-    if (best_score > WIN_THRESHOLD ) {
-        setAsciiFaceFlag(1); // 找到胜手来
-    } else if (best_score < -WIN_THRESHOLD / 3) {
-        setAsciiFaceFlag(-1); // 可能要输
-    } else {
-        setAsciiFaceFlag(0); // common
-    }
-    printf("AI selects move (%d, %d) with score %d after searching %lld nodes.\n", best_move.row, best_move.col, best_score, ctx.nodes_searched);
+    result->best_move = best_move;
+    result->score = best_score;
+    result->nodes = ctx.nodes_searched;
     return best_move;
 }
@@ -0,0 +1,323 @@
+#include "../include/annotate.h"
+#include "../include/interchange.h"
+#include "../include/corpus.h"
+#include "../include/board.h"
+#include "../include/rules.h"
+#include "../include/renju.h"
+#include "../include/ai.h"
+#include "../include/tt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <omp.h>
+
+#define MAX_MOVES (BOARD_SIZE * BOARD_SIZE)
+
+// 每批最多标注的盘数：读满一批就交给线程池，内存占用与输入总量无关
+#define ANNOTATE_BATCH 1024
+
+// 一盘待标注的棋
+typedef struct {
+    long long number;           // 文件内的序号（从1开始）
+    const unsigned char *moves; // 指向棋谱库的映射区或文本棋谱的走法缓冲
+    size_t offset;              // 文本棋谱：在走法缓冲中的偏移
+    int move_count;
+    RuleType rule;
+} AnnotateTask;
+
+// 当前一批对局：文本棋谱的走法全部存进一块连续缓冲
+typedef struct {
+    AnnotateTask tasks[ANNOTATE_BATCH];
+    char *texts[ANNOTATE_BATCH]; // 每盘的标注结果，各线程写自己的那一盘
+    size_t lengths[ANNOTATE_BATCH];
+    int count;
+    unsigned char *arena;
+    size_t arena_size, arena_capacity;
+} TaskList;
+
+typedef struct {
+    long long positions;
+    long long blunders;
+    unsigned long long nodes;
+} AnnotateStats;
+
+// 标注一个文件时的状态
+typedef struct {
+    const AnnotateOptions *options;
+    TranspositionTable **tts;    // 每个线程一张，按 omp_get_thread_num() 取
+    int threads;
+    TaskList *list;
+    FILE *out;
+    long long number;            // 当前文件已读入的盘数
+    long long games;             // 所有文件的总盘数
+    AnnotateStats stats;
+    int used_threads;
+} Annotator;
+
+void annotateDefaults(AnnotateOptions *options) {
+    options->max_depth = 8;
+    options->max_nodes = 0;
+    options->max_time = 0;
+    options->threads = 0;
+    options->tt_mb = 16;
+    options->blunder = 2000;
+    options->rule = RULE_STANDARD;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void flushBatch(Annotator *an);
+
+static AnnotateTask *appendTask(Annotator *an) {
+    TaskList *list = an->list;
+    if (list->count == ANNOTATE_BATCH) flushBatch(an);
+    AnnotateTask *task = &list->tasks[list->count++];
+    memset(task, 0, sizeof(*task));
+    task->number = ++an->number;
+    return task;
+}
+
+// 文本棋谱的导入回调：复制走法到缓冲
+static int collectGame(void *user, const CorpusGame *game) {
+    Annotator *an = (Annotator *)user;
+    AnnotateTask *task = appendTask(an); // 可能先标注并写出满的一批，缓冲随之清空
+    TaskList *list = an->list;
+    if (list->arena_size + game->move_count > list->arena_capacity) {
+        size_t capacity = list->arena_capacity ? list->arena_capacity : 4096;
+        while (capacity < list->arena_size + game->move_count) capacity *= 2;
+        unsigned char *arena = (unsigned char *)realloc(list->arena, capacity);
+        if (!arena) {
+            list->count--;
+            return 0;
+        }
+        list->arena = arena;
+        list->arena_capacity = capacity;
+    }
+    memcpy(list->arena + list->arena_size, game->moves, game->move_count);
+    task->offset = list->arena_size;
+    task->move_count = game->move_count;
+    task->rule = game->rule;
+    list->arena_size += game->move_count;
+    return 1;
+}
+
+static void printMove(FILE *out, Position p) {
+    char buf[16];
+    if (p.row < 0 || p.col < 0) snprintf(buf, sizeof(buf), "--");
+    else snprintf(buf, sizeof(buf), "%c%d", 'A' + p.col, BOARD_SIZE - p.row);
+    fprintf(out, " %-4s", buf);
+}
+
+// 标注一盘棋：局面 i 的分数是走第 i+1 步之前、轮到走棋方的搜索分数，
+// 所以第 i+1 步的实战价值就是 -scores[i+1]，每个局面只需要搜索一次
+static void annotateGame(const AnnotateTask *task, const AnnotateOptions *options,
+                         TranspositionTable *tt, FILE *out, AnnotateStats *stats) {
+    static const char *rule_names[] = {"Standard", "NaN"};
+    int scores[MAX_MOVES + 1];
+    Position best[MAX_MOVES + 1];
+    SearchLimits limits = {options->max_depth, 0, options->max_nodes, options->max_time, tt, NULL, 0};
+    GameState game;
+    int n = task->move_count;
+    int won = 0;
+
+    // 每盘棋从空表开始，结果与线程数、对局分配无关
+    tt_reset(tt);
+    initGame(&game, MODE_PVP, task->rule);
+    for (int i = 0; i <= n; i++) {
+        if (i > 0) {
+            unsigned char m = task->moves[i - 1];
+            makeMoveTrusted(&game, CORPUS_ROW(m), CORPUS_COL(m));
+            if (game.ruleType == RULE_STANDARD) {
+                forbiddenMapResolve(&game.forbidden, &game.bitBoard, board256Full());
+            }
+            // 已经分出胜负，后面的走法不再标注
+            if (checkWin(&game)) {
+                n = i;
+                won = 1;
+                break;
+            }
+        }
+        SearchResult result;
+        aiSearch(&game, &limits, &result);
+        scores[i] = result.score;
+        best[i] = result.best_move;
+        stats->nodes += result.nodes;
+        stats->positions++;
+    }
+
+    int blunders = 0;
+    fprintf(out, "# game %lld: %d moves, %s\n", task->number, n, rule_names[task->rule]);
+    fprintf(out, "# ply move best   score    loss\n");
+    for (int p = 1; p <= n; p++) {
+        unsigned char m = task->moves[p - 1];
+        int score = scores[p - 1];
+        int played = (p == n && won) ? score : -scores[p];
+        int loss = (score > played) ? score - played : 0;
+        fprintf(out, "%5d", p);
+        printMove(out, (Position){CORPUS_ROW(m), CORPUS_COL(m)});
+        printMove(out, best[p - 1]);
+        fprintf(out, " %7d %7d", score, loss);
+        if (loss >= options->blunder) {
+            fprintf(out, " ??");
+            blunders++;
+        }
+        fprintf(out, "\n");
+    }
+    fprintf(out, "# blunders: %d\n\n", blunders);
+    stats->blunders += blunders;
+}
+
+// 标注当前一批对局：各盘写进自己的缓冲，线程之间不互相等待，全部完成后按对局顺序写出
+static void flushBatch(Annotator *an) {
+    TaskList *list = an->list;
+    long long positions = 0, blunders = 0;
+    unsigned long long nodes = 0;
+    int used = 1;
+    if (list->count == 0) return;
+    // 缓冲在这一批内不再增长，现在可以把偏移换成指针
+    for (int t = 0; t < list->count; t++) {
+        if (!list->tasks[t].moves) list->tasks[t].moves = list->arena + list->tasks[t].offset;
+    }
+
+    #pragma omp parallel num_threads(an->threads) reduction(+:positions, blunders, nodes)
+    {
+        TranspositionTable *tt = an->tts[omp_get_thread_num()];
+        #pragma omp single nowait
+        used = omp_get_num_threads();
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int t = 0; t < list->count; t++) {
+            AnnotateStats stats = {0, 0, 0};
+            FILE *mem = open_memstream(&list->texts[t], &list->lengths[t]);
+            if (mem) {
+                annotateGame(&list->tasks[t], an->options, tt, mem, &stats);
+                fclose(mem);
+            } else {
+                list->texts[t] = NULL;
+            }
+            positions += stats.positions;
+            blunders += stats.blunders;
+            nodes += stats.nodes;
+        }
+    }
+
+    for (int t = 0; t < list->count; t++) {
+        if (list->texts[t]) fwrite(list->texts[t], 1, list->lengths[t], an->out);
+        free(list->texts[t]);
+        list->texts[t] = NULL;
+    }
+    an->stats.positions += positions;
+    an->stats.blunders += blunders;
+    an->stats.nodes += nodes;
+    an->games += list->count;
+    if (used > an->used_threads) an->used_threads = used;
+    list->count = 0;
+    list->arena_size = 0;
+}
+
+// 标注一个文件并写出 <path>.ann，没有对局时也写出只有文件头的 .ann
+static int annotateFile(Annotator *an, const char *path) {
+    const AnnotateOptions *options = an->options;
+    GameFormat format = formatFromPath(path);
+    long long rejected = 0;
+    int ok = 1;
+    char name[1024];
+    if (format == FORMAT_UNKNOWN) {
+        fprintf(stderr, "annotate: %s: unknown format\n", path);
+        return 0;
+    }
+    snprintf(name, sizeof(name), "%s.ann", path);
+    if (!(an->out = fopen(name, "w"))) {
+        perror(name);
+        return 0;
+    }
+    fprintf(an->out, "# %s: depth %d, nodes %llu, time %.3fs per position, blunder >= %d\n\n", path,
+            options->max_depth, options->max_nodes, options->max_time, options->blunder);
+    an->number = 0;
+
+    // 文本格式单遍读取，二进制棋谱库直接映射；读满一批就标注并写出
+    if (format == FORMAT_CORPUS) {
+        Corpus corpus;
+        if (corpusOpen(&corpus, path)) {
+            for (unsigned long long i = 0; i < corpus.game_count; i++) {
+                CorpusGame game;
+                if (!corpusGame(&corpus, i, &game)) {
+                    rejected++;
+                    continue;
+                }
+                AnnotateTask *task = appendTask(an);
+                task->moves = game.moves;
+                task->move_count = game.move_count;
+                task->rule = game.rule;
+            }
+            flushBatch(an); // 任务直接指向映射区，关闭前标注完
+            corpusClose(&corpus);
+        } else {
+            ok = 0;
+        }
+    } else {
+        FILE *fp = fopen(path, (format == FORMAT_RENLIB) ? "rb" : "r");
+        if (!fp || importGames(fp, format, options->rule, collectGame, an, &rejected) < 0) {
+            fprintf(stderr, "annotate: cannot read %s\n", path);
+            ok = 0;
+        }
+        if (fp) fclose(fp);
+        flushBatch(an);
+    }
+    if (rejected) fprintf(stderr, "annotate: %s: %lld invalid games skipped\n", path, rejected);
+    if (ok && an->number == 0) fprintf(stderr, "annotate: %s: no games to annotate\n", path);
+    if (fclose(an->out) != 0) {
+        perror(name);
+        ok = 0;
+    }
+    an->out = NULL;
+    return ok;
+}
+
+int annotateFiles(char **paths, int count, const AnnotateOptions *options) {
+    Annotator an;
+    int ready = 1, ok = 1;
+    memset(&an, 0, sizeof(an));
+    an.options = options;
+    an.threads = options->threads > 0 ? options->threads : omp_get_max_threads();
+    an.used_threads = 1;
+
+    // 开线程前先初始化全局表，并为每个线程分配置换表
+    aiInit();
+    an.list = (TaskList *)calloc(1, sizeof(TaskList));
+    an.tts = (TranspositionTable **)calloc(an.threads, sizeof(TranspositionTable *));
+    for (int i = 0; an.tts && i < an.threads; i++) {
+        if (!(an.tts[i] = tt_create(options->tt_mb))) {
+            fprintf(stderr, "annotate: cannot allocate a %d MB transposition table\n", options->tt_mb);
+            ready = 0;
+            break;
+        }
+    }
+    if (!an.list || !an.tts) ready = 0;
+
+    double start = now_seconds();
+    for (int f = 0; ready && f < count; f++) {
+        // 一个文件失败不影响其余文件
+        if (!annotateFile(&an, paths[f])) ok = 0;
+    }
+    double elapsed = now_seconds() - start;
+
+    if (ready) {
+        printf("annotate: %d files, %lld games, %lld positions, %lld blunders, %llu nodes in %.1fs (%.0f nps, %d threads)\n",
+               count, an.games, an.stats.positions, an.stats.blunders, an.stats.nodes, elapsed,
+               elapsed > 0 ? an.stats.nodes / elapsed : 0, an.used_threads);
+    }
+
+    for (int i = 0; an.tts && i < an.threads; i++) {
+        if (an.tts[i]) tt_destroy(an.tts[i]);
+    }
+    free(an.tts);
+    if (an.list) free(an.list->arena);
+    free(an.list);
+    return ready && ok;
+}
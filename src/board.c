@@ -3,23 +3,23 @@
 #include "../include/rules.h"
 #include "../include/history.h"
 #include "../include/bitboard.h"
+#include "../include/renju.h"
 
 #include "../include/evaluate.h"
 #include "../include/ascii_art.h"
 
 //初始化棋盘
 void initGame(GameState *game, GameMode mode, RuleType rule) {
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            game->board[i][j] = EMPTY;
-        }
-    }
     initBitBoard(&game->bitBoard); 
+    forbiddenMapInit(&game->forbidden);
+    if (rule == RULE_STANDARD) {
+        forbiddenMapResolve(&game->forbidden, &game->bitBoard, board256Full());
+    }
     game->currentPlayer = PLAYER_BLACK;
     game->moveCount = 0;
     game->mode = mode;
     game->ruleType = rule;
-    game->historyHead = NULL;
+    clearHistory(game);
     game->lastMove.row = -1;
     game->lastMove.col = -1;
 }
@@ -40,12 +40,15 @@ void printBoard(const GameState *game) {
         art_arr = ANGEL_AFRAID;
     }
     int art_lines = ANGEL_LINES;
+    // 轮到黑方时标出禁手点
+    int mark_forbidden = (game->ruleType == RULE_STANDARD && game->currentPlayer == PLAYER_BLACK);
     for (int i = 0; i < BOARD_SIZE; i++) {
         char rowBuf[256];
         int pos = 0;
         pos += snprintf(rowBuf + pos, sizeof(rowBuf) - pos, "%2d ", BOARD_SIZE - i);
         for (int j = 0; j < BOARD_SIZE; j++) {
-            if (game->board[i][j] == BLACK) { // 是黑子
+            CellState cell = getCell(game, i, j);
+            if (cell == BLACK) { // 是黑子
                 if (j == BOARD_SIZE - 1) {
                     if (i == game->lastMove.row && j == game->lastMove.col)
                         pos += snprintf(rowBuf + pos, sizeof(rowBuf) - pos, "▲");
@@ -58,7 +61,7 @@ void printBoard(const GameState *game) {
                         pos += snprintf(rowBuf + pos, sizeof(rowBuf) - pos, "●─");
                 }
             }
-            else if (game->board[i][j] == WHITE) { // 是白子
+            else if (cell == WHITE) { // 是白子
                 if (j == BOARD_SIZE - 1) {
                     if (i == game->lastMove.row && j == game->lastMove.col)
                         pos += snprintf(rowBuf + pos, sizeof(rowBuf) - pos, "△");
@@ -70,6 +73,8 @@ void printBoard(const GameState *game) {
                     else
                         pos += snprintf(rowBuf + pos, sizeof(rowBuf) - pos, "◎─");
                 }
+            } else if (mark_forbidden && board256Test(&game->forbidden.forbidden, i, j)) { // 黑方禁手点
+                pos += snprintf(rowBuf + pos, sizeof(rowBuf) - pos, (j == BOARD_SIZE - 1) ? "×" : "×─");
             } else if (i == 0) { // 顶部空格
                 if (j == 0)                   { pos += snprintf(rowBuf + pos, sizeof(rowBuf) - pos, "┌─");  }
                 else if (j == BOARD_SIZE - 1) { pos += snprintf(rowBuf + pos, sizeof(rowBuf) - pos, "┐"); }
@@ -101,7 +106,10 @@ void printBoard(const GameState *game) {
             printf("    %s\n", art_arr[k]);
         }
     }
-    printf("Enter moves as 'H8' or '8H', 'undo' to undo, 'quit' to exit.\n");
+    if (mark_forbidden && !board256IsEmpty(game->forbidden.forbidden)) {
+        printf("'×' marks points forbidden for black.\n");
+    }
+    printf("Enter moves as 'H8' or '8H', 'undo' to undo, 'redo' to redo, 'quit' to exit.\n");
 
     //调试日志
     // printf("\n--- BitBoard Debug Info (Cols) ---\n");
@@ -156,21 +164,26 @@ int makeMove(GameState *game, int row, int col) {
     if (valid != VALID_MOVE) {
         return valid; 
     }
+    makeMoveTrusted(game, row, col);
+    if (game->ruleType == RULE_STANDARD) {
+        forbiddenMapResolve(&game->forbidden, &game->bitBoard, board256Full());
+    }
+    return VALID_MOVE;
+}
 
-    pushState(game);
+void makeMoveTrusted(GameState *game, int row, int col) {
+    pushMove(game, row, col);
 
-    game->board[row][col] = (game->currentPlayer == PLAYER_BLACK) ? BLACK : WHITE;
-    
-    Line backup_mask[BOARD_SIZE]; // 用于备份掩码
-    updateBitBoard(&game->bitBoard, row, col, game->currentPlayer, backup_mask); 
+    updateBitBoard(&game->bitBoard, row, col, game->currentPlayer);
+
+    // 只标记受这一步影响的点，由调用方决定何时重新判断
+    forbiddenMapTouch(&game->forbidden, row, col);
 
     game->lastMove.row = row;
     game->lastMove.col = col;
     game->moveCount++;
     
     game->currentPlayer = (game->currentPlayer == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK;
-
-    return VALID_MOVE;
 }
 
 int isBoardFull(const GameState *game) {
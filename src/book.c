@@ -0,0 +1,177 @@
+#include "../include/book.h"
+#include "../include/interchange.h"
+#include "../include/corpus.h"
+#include "../include/zobrist.h"
+#include "../include/ai.h"
+#include "../include/rules.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void bookInit(OpeningBook *book, int max_ply) {
+    memset(book, 0, sizeof(*book));
+    book->max_ply = (max_ply > 0) ? max_ply : BOOK_DEFAULT_PLY;
+}
+
+void bookFree(OpeningBook *book) {
+    free(book->entries);
+    memset(book, 0, sizeof(*book));
+}
+
+// 第 s 种对称变换：bit0 左右翻转，bit1 上下翻转，bit2 沿主对角线翻转
+static void transform(int s, int *row, int *col) {
+    int r = *row, c = *col;
+    if (s & 1) c = BOARD_SIZE - 1 - c;
+    if (s & 2) r = BOARD_SIZE - 1 - r;
+    if (s & 4) {
+        int t = r;
+        r = c;
+        c = t;
+    }
+    *row = r;
+    *col = c;
+}
+
+static int appendEntry(OpeningBook *book, uint64_t key, RuleType rule, int row, int col, int decided, int win) {
+    if (book->count == book->capacity) {
+        size_t capacity = book->capacity ? book->capacity * 2 : 4096;
+        BookEntry *entries = (BookEntry *)realloc(book->entries, capacity * sizeof(BookEntry));
+        if (!entries) return 0;
+        book->entries = entries;
+        book->capacity = capacity;
+    }
+    BookEntry *e = &book->entries[book->count++];
+    e->key = key;
+    e->rule = (unsigned char)rule;
+    e->move = CORPUS_MOVE(row, col);
+    e->count = 1;
+    e->decided = decided;
+    e->wins = win;
+    return 1;
+}
+
+static int compareEntry(const void *a, const void *b) {
+    const BookEntry *x = (const BookEntry *)a, *y = (const BookEntry *)b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    if (x->rule != y->rule) return x->rule - y->rule;
+    return x->move - y->move;
+}
+
+// 棋谱没有记录结果时（文本格式导入的都是这样）按终局判断：最后一步成五则下这一步的一方获胜
+static int gameResult(const CorpusGame *game) {
+    GameState state;
+    if (game->result != CORPUS_RESULT_UNKNOWN) return game->result;
+    if (game->move_count == 0 || !corpusReplay(&state, game)) return CORPUS_RESULT_UNKNOWN;
+    int winner = checkWin(&state);
+    return winner ? winner : CORPUS_RESULT_UNKNOWN;
+}
+
+// 导入回调：前 max_ply 步按8种对称各记一次，哈希直接按落子增量计算。
+// 对称的局面（如天元开局）在几种变换下得到相同的 (局面, 走法)，同一盘棋里只记一次，
+// 否则对称轴上的走法会比其他走法多计几倍
+static int addGame(void *user, const CorpusGame *game) {
+    OpeningBook *book = (OpeningBook *)user;
+    int plies = game->move_count < book->max_ply ? game->move_count : book->max_ply;
+    int result = gameResult(game);
+    int decided = (result == CORPUS_RESULT_BLACK || result == CORPUS_RESULT_WHITE);
+    size_t start = book->count;
+    for (int s = 0; s < 8; s++) {
+        uint64_t key = 0;
+        Player player = PLAYER_BLACK;
+        for (int i = 0; i < plies; i++) {
+            int row = CORPUS_ROW(game->moves[i]), col = CORPUS_COL(game->moves[i]);
+            transform(s, &row, &col);
+            if (!appendEntry(book, key, game->rule, row, col, decided, result == (int)player)) return 0;
+            key ^= zobrist_table[row][col][player == PLAYER_BLACK ? 0 : 1] ^ zobrist_player;
+            player = (player == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK;
+        }
+    }
+    qsort(book->entries + start, book->count - start, sizeof(BookEntry), compareEntry);
+    size_t n = start;
+    for (size_t i = start; i < book->count; i++) {
+        if (n == start || compareEntry(&book->entries[n - 1], &book->entries[i]) != 0) book->entries[n++] = book->entries[i];
+    }
+    book->count = n;
+    book->games++;
+    return 1;
+}
+
+long long bookAddFile(OpeningBook *book, const char *path, RuleType rule) {
+    GameFormat format = formatFromPath(path);
+    long long before = book->games;
+    aiInit(); // Zobrist 表
+    if (format == FORMAT_CORPUS) {
+        Corpus corpus;
+        if (!corpusOpen(&corpus, path)) return -1;
+        for (unsigned long long i = 0; i < corpus.game_count; i++) {
+            CorpusGame game;
+            if (corpusGame(&corpus, i, &game) && !addGame(book, &game)) break;
+        }
+        corpusClose(&corpus);
+    } else if (format != FORMAT_UNKNOWN) {
+        FILE *fp = fopen(path, (format == FORMAT_RENLIB) ? "rb" : "r");
+        if (!fp) return -1;
+        long long games = importGames(fp, format, rule, addGame, book, NULL);
+        fclose(fp);
+        if (games < 0) return -1;
+    } else {
+        return -1;
+    }
+    return book->games - before;
+}
+
+int bookFinish(OpeningBook *book) {
+    if (book->count == 0) return 1;
+    qsort(book->entries, book->count, sizeof(BookEntry), compareEntry);
+    size_t n = 0;
+    for (size_t i = 0; i < book->count; i++) {
+        if (n > 0 && compareEntry(&book->entries[n - 1], &book->entries[i]) == 0) {
+            book->entries[n - 1].count += book->entries[i].count;
+            book->entries[n - 1].decided += book->entries[i].decided;
+            book->entries[n - 1].wins += book->entries[i].wins;
+        } else {
+            book->entries[n++] = book->entries[i];
+        }
+    }
+    book->count = n;
+    BookEntry *shrunk = (BookEntry *)realloc(book->entries, n * sizeof(BookEntry));
+    if (shrunk) book->entries = shrunk;
+    book->capacity = n;
+    return 1;
+}
+
+int bookProbe(const OpeningBook *book, const GameState *game, BookMove *moves, int max) {
+    if (max <= 0 || book->count == 0 || game->moveCount >= book->max_ply) return 0;
+    uint64_t key = calculateZobristHash(&game->bitBoard, game->currentPlayer);
+
+    // 二分查找第一个 key 相同的条目
+    size_t lo = 0, hi = book->count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (book->entries[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+
+    int n = 0;
+    for (size_t i = lo; i < book->count && book->entries[i].key == key; i++) {
+        const BookEntry *e = &book->entries[i];
+        // 规则不同，或者棋谱里的这一步在当前规则下不合法（如黑方禁手）
+        if (e->rule != (unsigned char)game->ruleType ||
+            checkValidMove(game, CORPUS_ROW(e->move), CORPUS_COL(e->move)) != VALID_MOVE) {
+            continue;
+        }
+        // 按次数插入
+        int j = (n < max) ? n : max - 1;
+        if (n == max && moves[j].count >= e->count) continue;
+        while (j > 0 && moves[j - 1].count < e->count) {
+            moves[j] = moves[j - 1];
+            j--;
+        }
+        moves[j].move = (Position){CORPUS_ROW(e->move), CORPUS_COL(e->move)};
+        moves[j].count = e->count;
+        moves[j].decided = e->decided;
+        moves[j].wins = e->wins;
+        if (n < max) n++;
+    }
+    return n;
+}
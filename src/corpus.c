@@ -0,0 +1,164 @@
+#include "../include/corpus.h"
+#include "../include/board.h"
+#include "../include/renju.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+int corpusOpen(Corpus *corpus, const char *path) {
+    memset(corpus, 0, sizeof(*corpus));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "corpus: cannot open %s\n", path);
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CorpusHeader)) {
+        close(fd);
+        fprintf(stderr, "corpus: %s is truncated\n", path);
+        return 0;
+    }
+    void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("corpus: mmap");
+        return 0;
+    }
+
+    // 校验文件头与索引表的位置
+    const CorpusHeader *header = (const CorpusHeader *)base;
+    size_t size = st.st_size;
+    if (header->magic != CORPUS_MAGIC || header->version != CORPUS_VERSION ||
+        header->index_offset < sizeof(CorpusHeader) || header->index_offset > size ||
+        header->game_count > (size - header->index_offset) / sizeof(CorpusIndexEntry)) {
+        munmap(base, size);
+        fprintf(stderr, "corpus: %s has a bad header\n", path);
+        return 0;
+    }
+    // 批量导入按顺序扫过整个文件
+    madvise(base, size, MADV_SEQUENTIAL);
+
+    corpus->base = (const unsigned char *)base;
+    corpus->size = size;
+    corpus->game_count = header->game_count;
+    corpus->index = corpus->base + header->index_offset;
+    return 1;
+}
+
+void corpusClose(Corpus *corpus) {
+    if (corpus->base) {
+        munmap((void *)corpus->base, corpus->size);
+    }
+    memset(corpus, 0, sizeof(*corpus));
+}
+
+int corpusGame(const Corpus *corpus, unsigned long long i, CorpusGame *game) {
+    if (i >= corpus->game_count) return 0;
+    CorpusIndexEntry e;
+    memcpy(&e, corpus->index + i * sizeof(CorpusIndexEntry), sizeof(e));
+    if (e.offset < sizeof(CorpusHeader) || e.offset > corpus->size ||
+        e.move_count > corpus->size - e.offset ||
+        (e.rule != RULE_STANDARD && e.rule != RULE_NO_FORBIDDEN)) {
+        return 0;
+    }
+    // 与文本格式导入相同的检查：坐标越界或重复落子的对局不交给调用方
+    unsigned char seen[BOARD_SIZE * BOARD_SIZE] = {0};
+    const unsigned char *moves = corpus->base + e.offset;
+    for (int k = 0; k < e.move_count; k++) {
+        if (moves[k] >= BOARD_SIZE * BOARD_SIZE || seen[moves[k]]) return 0;
+        seen[moves[k]] = 1;
+    }
+    game->moves = corpus->base + e.offset;
+    game->move_count = e.move_count;
+    game->rule = (RuleType)e.rule;
+    game->result = e.result;
+    return 1;
+}
+
+int corpusReplay(GameState *game, const CorpusGame *record) {
+    initGame(game, MODE_PVP, record->rule);
+    for (int i = 0; i < record->move_count; i++) {
+        unsigned char m = record->moves[i];
+        if (m >= BOARD_SIZE * BOARD_SIZE || getCell(game, CORPUS_ROW(m), CORPUS_COL(m)) != EMPTY) return 0;
+        makeMoveTrusted(game, CORPUS_ROW(m), CORPUS_COL(m));
+    }
+    // 整盘回放完只判断一次禁手
+    if (game->ruleType == RULE_STANDARD) {
+        forbiddenMapResolve(&game->forbidden, &game->bitBoard, board256Full());
+    }
+    return 1;
+}
+
+int corpusWriterOpen(CorpusWriter *writer, const char *path) {
+    memset(writer, 0, sizeof(*writer));
+    writer->fp = fopen(path, "wb");
+    if (!writer->fp) {
+        perror("corpus");
+        return 0;
+    }
+    // 先占位，关闭时回填
+    CorpusHeader header = {0};
+    if (fwrite(&header, sizeof(header), 1, writer->fp) != 1) {
+        fclose(writer->fp);
+        writer->fp = NULL;
+        return 0;
+    }
+    writer->offset = sizeof(header);
+    return 1;
+}
+
+int corpusWriterAdd(CorpusWriter *writer, const unsigned char *moves, int move_count, RuleType rule, int result) {
+    if (!writer->fp || move_count < 0 || move_count > BOARD_SIZE * BOARD_SIZE) return 0;
+    if (writer->game_count == writer->capacity) {
+        unsigned long long capacity = writer->capacity ? writer->capacity * 2 : 1024;
+        CorpusIndexEntry *index = (CorpusIndexEntry *)realloc(writer->index, capacity * sizeof(CorpusIndexEntry));
+        if (!index) return 0;
+        writer->index = index;
+        writer->capacity = capacity;
+    }
+    if (move_count > 0 && fwrite(moves, 1, move_count, writer->fp) != (size_t)move_count) return 0;
+
+    CorpusIndexEntry *e = &writer->index[writer->game_count++];
+    memset(e, 0, sizeof(*e));
+    e->offset = writer->offset;
+    e->move_count = (unsigned short)move_count;
+    e->rule = (unsigned char)rule;
+    e->result = (unsigned char)result;
+    writer->offset += move_count;
+    return 1;
+}
+
+int corpusWriterAddGame(CorpusWriter *writer, const GameState *game, int result) {
+    unsigned char moves[BOARD_SIZE * BOARD_SIZE];
+    int count = game->history.count;
+    for (int i = 0; i < count; i++) {
+        moves[i] = CORPUS_MOVE(game->history.moves[i].row, game->history.moves[i].col);
+    }
+    return corpusWriterAdd(writer, moves, count, game->ruleType, result);
+}
+
+int corpusWriterClose(CorpusWriter *writer) {
+    if (!writer->fp) return 0;
+    CorpusHeader header = {0};
+    header.magic = CORPUS_MAGIC;
+    header.version = CORPUS_VERSION;
+    header.game_count = writer->game_count;
+    // 索引表按8字节对齐
+    static const unsigned char padding[8] = {0};
+    size_t pad = (size_t)(-writer->offset & 7);
+    header.index_offset = writer->offset + pad;
+
+    int ok = fwrite(padding, 1, pad, writer->fp) == pad &&
+             fwrite(writer->index, sizeof(CorpusIndexEntry), writer->game_count, writer->fp) == writer->game_count &&
+             fseek(writer->fp, 0, SEEK_SET) == 0 &&
+             fwrite(&header, sizeof(header), 1, writer->fp) == 1;
+    ok = (fclose(writer->fp) == 0) && ok;
+    free(writer->index);
+    memset(writer, 0, sizeof(*writer));
+    return ok;
+}
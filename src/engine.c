@@ -0,0 +1,199 @@
+#include "../include/engine.h"
+#include "../include/board.h"
+#include "../include/rules.h"
+#include "../include/history.h"
+#include "../include/ascii_art.h"
+#include "../include/tt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+struct Engine {
+    GameState game;
+    TranspositionTable *tt;
+    int tt_mb;
+    SearchLimits limits;
+    atomic_int stop;             // engine_stop 置1；由 engine_clear_stop、engine_start、engine_wait 清零，engine_search 不清零
+    SearchInfoCallback on_info;
+    void *user;
+    // 后台搜索
+    pthread_t thread;
+    int running;                 // 已启动且尚未 engine_wait
+    atomic_int done;
+    SearchLimits async_limits;
+    SearchResult async_result;
+};
+
+void engine_default_config(EngineConfig *config) {
+    config->tt_mb = ENGINE_DEFAULT_TT_MB;
+    config->limits = (SearchLimits){SEARCH_DEPTH, 0, 0, 0, NULL, NULL, 0};
+}
+
+Engine *engine_new(const EngineConfig *config) {
+    EngineConfig defaults;
+    if (!config) {
+        engine_default_config(&defaults);
+        config = &defaults;
+    }
+
+    // 只读全局表在第一个实例创建时初始化
+    aiInit();
+
+    Engine *engine = (Engine *)calloc(1, sizeof(Engine));
+    if (!engine) return NULL;
+    engine->limits = config->limits;
+    engine->limits.tt = NULL;
+    if (!engine_resize_tt(engine, config->tt_mb > 0 ? config->tt_mb : ENGINE_DEFAULT_TT_MB)) {
+        free(engine);
+        return NULL;
+    }
+    initGame(&engine->game, MODE_PVE, RULE_STANDARD);
+    return engine;
+}
+
+void engine_free(Engine *engine) {
+    if (!engine) return;
+    if (engine->running) {
+        engine_stop(engine);
+        engine_wait(engine, NULL);
+    }
+    tt_destroy(engine->tt);
+    free(engine);
+}
+
+int engine_resize_tt(Engine *engine, int tt_mb) {
+    if (tt_mb < 1) tt_mb = 1;
+    if (engine->tt && engine->tt_mb == tt_mb) return 1;
+    tt_destroy(engine->tt);
+    engine->tt = tt_create(tt_mb);
+    engine->tt_mb = tt_mb;
+    return engine->tt != NULL;
+}
+
+void engine_clear(Engine *engine) {
+    if (engine->tt) tt_reset(engine->tt);
+}
+
+int engine_set_position(Engine *engine, RuleType rule, const Position *moves, int count) {
+    initGame(&engine->game, MODE_PVE, rule);
+    for (int i = 0; i < count; i++) {
+        int err = makeMove(&engine->game, moves[i].row, moves[i].col);
+        if (err != VALID_MOVE) return err;
+    }
+    return VALID_MOVE;
+}
+
+void engine_set_game(Engine *engine, const GameState *game) {
+    engine->game = *game;
+}
+
+int engine_play(Engine *engine, int row, int col) {
+    return makeMove(&engine->game, row, col);
+}
+
+int engine_undo(Engine *engine) {
+    return undoMove(&engine->game);
+}
+
+const GameState *engine_game(const Engine *engine) {
+    return &engine->game;
+}
+
+Position engine_search(Engine *engine, const SearchLimits *limits, SearchResult *result) {
+    SearchLimits l = limits ? *limits : engine->limits;
+    SearchControl control = {&engine->stop, engine->on_info, engine->user};
+    l.tt = engine->tt;
+    // 不在这里清零停止标志：搜索开始前收到的 engine_stop 不会丢失
+    return aiSearchControlled(&engine->game, &l, &control, result);
+}
+
+void engine_set_info_callback(Engine *engine, SearchInfoCallback on_info, void *user) {
+    engine->on_info = on_info;
+    engine->user = user;
+}
+
+static void *searchThread(void *arg) {
+    Engine *engine = (Engine *)arg;
+    SearchControl control = {&engine->stop, engine->on_info, engine->user};
+    aiSearchControlled(&engine->game, &engine->async_limits, &control, &engine->async_result);
+    atomic_store(&engine->done, 1);
+    return NULL;
+}
+
+int engine_start(Engine *engine, const SearchLimits *limits) {
+    if (engine->running) return 0;
+    engine->async_limits = limits ? *limits : engine->limits;
+    engine->async_limits.tt = engine->tt;
+    // 停止标志在启动前清零，engine_start 返回后的 engine_stop 一定有效
+    atomic_store(&engine->stop, 0);
+    atomic_store(&engine->done, 0);
+    if (pthread_create(&engine->thread, NULL, searchThread, engine) != 0) return 0;
+    engine->running = 1;
+    return 1;
+}
+
+void engine_stop(Engine *engine) {
+    atomic_store(&engine->stop, 1);
+}
+
+void engine_clear_stop(Engine *engine) {
+    atomic_store(&engine->stop, 0);
+}
+
+int engine_searching(Engine *engine) {
+    return engine->running && !atomic_load(&engine->done);
+}
+
+Position engine_wait(Engine *engine, SearchResult *result) {
+    if (!engine->running) {
+        if (result) result->best_move = INVALID_POS;
+        return INVALID_POS;
+    }
+    pthread_join(engine->thread, NULL);
+    engine->running = 0;
+    atomic_store(&engine->stop, 0); // 停止请求已由这次后台搜索处理
+    if (result) *result = engine->async_result;
+    return engine->async_result.best_move;
+}
+
+static Engine *default_engine = NULL;
+
+Engine *engine_default_if_created(void) {
+    return default_engine;
+}
+
+Engine *engine_default(void) {
+    Engine *engine = default_engine;
+    if (!engine) {
+        EngineConfig config;
+        engine_default_config(&config);
+        config.limits.verbose = 1;
+        engine = engine_new(&config);
+        if (!engine) {
+            fprintf(stderr, "engine: cannot allocate the transposition table\n");
+            exit(1);
+        }
+        default_engine = engine;
+    }
+    return engine;
+}
+
+Position getAIMove(const GameState *game) {
+    Engine *engine = engine_default();
+    SearchResult result;
+    engine_set_game(engine, game);
+    Position best_move = engine_search(engine, NULL, &result);
+    if (game->moveCount == 0) return best_move;
+
+    // Set ascii face flag according to final best_score
+    if (result.score > WIN_THRESHOLD ) {
+        setAsciiFaceFlag(1); // 找到胜手来
+    } else if (result.score < -WIN_THRESHOLD / 3) {
+        setAsciiFaceFlag(-1); // 可能要输
+    } else {
+        setAsciiFaceFlag(0); // common
+    }
+    printf("AI selects move (%d, %d) with score %d after searching %lld nodes.\n", best_move.row, best_move.col, result.score, result.nodes);
+    return best_move;
+}
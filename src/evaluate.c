@@ -1,5 +1,11 @@
 #include "../include/evaluate.h"
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EVAL_X86_KERNELS 1
+#endif
 
 // Helper macro 
 #define POPCOUNT(x) __builtin_popcount(x)
@@ -79,11 +85,33 @@
 //     return score;
 // }
 
-// 并行评估4条线（通过数组打包进行向量化）
+// Helper: 出现五连时的打分，与各内核共用
+// res_m5 布局: [Me_Low, Me_High, Enemy_Low, Enemy_High]，返回1表示有五连
+static inline int lines4FiveScores(const unsigned long long res_m5[4], DualLines *scores) {
+    // 检查五连
+    // 索引: 0=我方低, 1=我方高, 2=敌方低, 3=敌方高
+    if (res_m5[0] | res_m5[1]) {
+        if (res_m5[0] & 0xFFFFFFFFULL) scores->me.low |= (unsigned long long)SCORE_FIVE;
+        if (res_m5[0] & 0xFFFFFFFF00000000ULL) scores->me.low |= ((unsigned long long)SCORE_FIVE << 32);
+        if (res_m5[1] & 0xFFFFFFFFULL) scores->me.high |= (unsigned long long)SCORE_FIVE;
+        if (res_m5[1] & 0xFFFFFFFF00000000ULL) scores->me.high |= ((unsigned long long)SCORE_FIVE << 32);
+        return 1;
+    }
+    if (res_m5[2] | res_m5[3]) {
+        if (res_m5[2] & 0xFFFFFFFFULL) scores->enemy.low |= (unsigned long long)SCORE_FIVE;
+        if (res_m5[2] & 0xFFFFFFFF00000000ULL) scores->enemy.low |= ((unsigned long long)SCORE_FIVE << 32);
+        if (res_m5[3] & 0xFFFFFFFFULL) scores->enemy.high |= (unsigned long long)SCORE_FIVE;
+        if (res_m5[3] & 0xFFFFFFFF00000000ULL) scores->enemy.high |= ((unsigned long long)SCORE_FIVE << 32);
+        return 1;
+    }
+    return 0;
+}
+
+// 通用内核：并行评估4条线（通过数组打包进行向量化）
 // 这种方法将4条线（我方低/高，敌方低/高）打包到数组中
 // 允许编译器使用AVX2/SIMD进行位运算向量化。
 // POPCOUNT随后作为标量指令顺序执行。
-DualLines evaluateLines4(Lines4 me, Lines4 enemy, Lines4 mask) {
+static DualLines evaluateLines4Generic(Lines4 me, Lines4 enemy, Lines4 mask) {
     DualLines scores = {{0, 0}, {0, 0}};
 
     // 1. 预计算有效位（我方与敌方的交互，不适合统一SIMD循环）
@@ -180,22 +208,7 @@ DualLines evaluateLines4(Lines4 me, Lines4 enemy, Lines4 mask) {
     // 标量计分，没有256位的POPCOUNT指令
     // ==========================================================
 
-    // 检查五连
-    // 索引: 0=我方低, 1=我方高, 2=敌方低, 3=敌方高
-    if (res_m5[0] | res_m5[1]) {
-        if (res_m5[0] & 0xFFFFFFFFULL) scores.me.low |= (unsigned long long)SCORE_FIVE;
-        if (res_m5[0] & 0xFFFFFFFF00000000ULL) scores.me.low |= ((unsigned long long)SCORE_FIVE << 32);
-        if (res_m5[1] & 0xFFFFFFFFULL) scores.me.high |= (unsigned long long)SCORE_FIVE;
-        if (res_m5[1] & 0xFFFFFFFF00000000ULL) scores.me.high |= ((unsigned long long)SCORE_FIVE << 32);
-        return scores;
-    }
-    if (res_m5[2] | res_m5[3]) {
-        if (res_m5[2] & 0xFFFFFFFFULL) scores.enemy.low |= (unsigned long long)SCORE_FIVE;
-        if (res_m5[2] & 0xFFFFFFFF00000000ULL) scores.enemy.low |= ((unsigned long long)SCORE_FIVE << 32);
-        if (res_m5[3] & 0xFFFFFFFFULL) scores.enemy.high |= (unsigned long long)SCORE_FIVE;
-        if (res_m5[3] & 0xFFFFFFFF00000000ULL) scores.enemy.high |= ((unsigned long long)SCORE_FIVE << 32);
-        return scores;
-    }
+    if (lines4FiveScores(res_m5, &scores)) return scores;
 
     // 累加分数
     unsigned long long* targets[4] = {&scores.me.low, &scores.me.high, &scores.enemy.low, &scores.enemy.high};
@@ -227,6 +240,481 @@ DualLines evaluateLines4(Lines4 me, Lines4 enemy, Lines4 mask) {
     return scores;
 }
 
+#ifdef EVAL_X86_KERNELS
+// ==========================================================
+// 手写 SIMD 内核
+// 4个64位通道: [Me_Low, Me_High, Enemy_Low, Enemy_High]，每个64位通道含两条线
+// 模式匹配与计分全部在向量寄存器中完成，计分按32位（单条线）通道累加，
+// 打包结果与通用内核逐位一致。
+// ==========================================================
+
+// 9种棋型特征
+#define LINES4_FEATURES 9
+
+// 模式匹配，与通用内核的循环体一一对应
+// feats: live2, rush2, strong_live2, live_jump3, live3, rush3, live4, rush4, jump4
+__attribute__((target("avx2")))
+static inline __m256i lines4PatternsAVX2(__m256i my_line, __m256i valid, __m256i feats[LINES4_FEATURES]) {
+    #define SHL(x, n) _mm256_slli_epi64((x), (n))
+    #define SHR(x, n) _mm256_srli_epi64((x), (n))
+    #define AND(a, b) _mm256_and_si256((a), (b))
+    #define OR(a, b) _mm256_or_si256((a), (b))
+    #define XOR(a, b) _mm256_xor_si256((a), (b))
+    #define ANDNOT(a, b) _mm256_andnot_si256((a), (b)) // ~a & b
+
+    __m256i mask_0xxxx0 = AND(SHR(valid, 4), SHL(valid, 1));
+    __m256i mask_axxxxb = XOR(SHR(valid, 4), SHL(valid, 1));
+
+    // ---基础连子 ---
+    __m256i m2 = AND(my_line, SHR(my_line, 1));
+    __m256i m3 = AND(m2, SHR(m2, 1));
+    __m256i m4 = AND(m3, SHR(m3, 1));
+    __m256i m5 = AND(m4, SHR(m4, 1));
+
+    // --- 精炼连二 ---
+    m2 = ANDNOT(OR(m3, SHL(m3, 1)), m2);
+
+    // --- 活二、冲二、强活二 ---
+    __m256i live2 = AND(AND(SHL(valid, 1), m2), SHR(valid, 2));
+    feats[0] = live2;
+    feats[1] = AND(m2, XOR(SHL(valid, 1), SHR(valid, 2)));
+    feats[2] = AND(AND(SHL(valid, 2), live2), SHR(valid, 3));
+
+    // --- 跳三 ---
+    __m256i jump3_a = AND(AND(my_line, SHR(m2, 2)), SHR(valid, 1));
+    __m256i jump3_b = AND(AND(SHR(my_line, 3), m2), SHR(valid, 2));
+    feats[3] = AND(OR(jump3_a, jump3_b), mask_0xxxx0);
+
+    // --- 活四与冲四 ---
+    feats[6] = AND(m4, mask_0xxxx0);
+    feats[7] = AND(m4, mask_axxxxb);
+
+    // --- 跳四 ---
+    __m256i jump4_1 = AND(AND(my_line, SHR(valid, 1)), SHR(m3, 2));
+    __m256i jump4_2 = AND(AND(m2, SHR(valid, 2)), SHR(m2, 3));
+    __m256i jump4_3 = AND(AND(m3, SHR(valid, 3)), SHR(my_line, 4));
+    feats[8] = OR(OR(jump4_1, jump4_2), jump4_3);
+
+    // --- 最终活三与冲三 ---
+    __m256i not_fake = OR(SHL(jump4_1, 2), jump4_3);
+    feats[4] = ANDNOT(not_fake, AND(AND(SHL(valid, 1), m3), SHR(valid, 3)));
+    feats[5] = ANDNOT(not_fake, AND(XOR(SHL(valid, 1), SHR(valid, 3)), m3));
+
+    #undef SHL
+    #undef SHR
+    #undef AND
+    #undef OR
+    #undef XOR
+    #undef ANDNOT
+    return m5;
+}
+
+// 每种特征的权重（含活三/四计数位），顺序同 lines4PatternsAVX2
+static const int lines4_weights[LINES4_FEATURES] = {
+    SCORE_LIVE_2, SCORE_RUSH_2, (SCORE_STRONG_LIVE_2 - SCORE_LIVE_2), (SCORE_JUMP_LIVE_3 - SCORE_LIVE_2),
+    SCORE_LIVE_3, SCORE_RUSH_3, (SCORE_LIVE_4 - 2 * SCORE_RUSH_3), (SCORE_RUSH_4 - SCORE_RUSH_3), SCORE_RUSH_4,
+};
+
+// 打包输入: 返回 [Me_Low, Me_High, Enemy_Low, Enemy_High] 与对应的有效位
+#define LINES4_LOAD(me, enemy, mask, my_line, valid) do { \
+        unsigned long long valid_low = ~((me).low | (enemy).low) & (mask).low; \
+        unsigned long long valid_high = ~((me).high | (enemy).high) & (mask).high; \
+        my_line = _mm256_setr_epi64x((long long)(me).low, (long long)(me).high, (long long)(enemy).low, (long long)(enemy).high); \
+        valid = _mm256_setr_epi64x((long long)valid_low, (long long)valid_high, (long long)valid_low, (long long)valid_high); \
+    } while (0)
+
+// 把累加结果或五连分写回 DualLines
+#define LINES4_STORE(m5, acc, scores) do { \
+        if (!_mm256_testz_si256(m5, m5)) { \
+            unsigned long long res_m5[4]; \
+            _mm256_storeu_si256((__m256i *)res_m5, m5); \
+            lines4FiveScores(res_m5, &(scores)); \
+        } else { \
+            unsigned long long out[4]; \
+            _mm256_storeu_si256((__m256i *)out, acc); \
+            (scores).me.low = out[0]; (scores).me.high = out[1]; \
+            (scores).enemy.low = out[2]; (scores).enemy.high = out[3]; \
+        } \
+    } while (0)
+
+// AVX2: 用 PSHUFB 查4位半字节表求每字节的popcount，再用 maddubs/madd 横向加到32位通道
+__attribute__((target("avx2")))
+static inline __m256i popcount32AVX2(__m256i x) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_and_si256(x, low_nibble);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), low_nibble);
+    __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+    __m256i words = _mm256_maddubs_epi16(bytes, _mm256_set1_epi8(1));
+    return _mm256_madd_epi16(words, _mm256_set1_epi16(1));
+}
+
+__attribute__((target("avx2")))
+static DualLines evaluateLines4AVX2(Lines4 me, Lines4 enemy, Lines4 mask) {
+    DualLines scores = {{0, 0}, {0, 0}};
+    __m256i my_line, valid, feats[LINES4_FEATURES];
+    LINES4_LOAD(me, enemy, mask, my_line, valid);
+
+    __m256i m5 = lines4PatternsAVX2(my_line, valid, feats);
+    __m256i acc = _mm256_setzero_si256();
+    for (int f = 0; f < LINES4_FEATURES; f++) {
+        __m256i count = popcount32AVX2(feats[f]);
+        acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(count, _mm256_set1_epi32(lines4_weights[f])));
+    }
+
+    LINES4_STORE(m5, acc, scores);
+    return scores;
+}
+
+// AVX-512: VPOPCNTD 直接对32位通道求popcount（需 AVX512_VPOPCNTDQ + AVX512VL）
+__attribute__((target("avx2,avx512f,avx512vl,avx512vpopcntdq")))
+static DualLines evaluateLines4AVX512(Lines4 me, Lines4 enemy, Lines4 mask) {
+    DualLines scores = {{0, 0}, {0, 0}};
+    __m256i my_line, valid, feats[LINES4_FEATURES];
+    LINES4_LOAD(me, enemy, mask, my_line, valid);
+
+    __m256i m5 = lines4PatternsAVX2(my_line, valid, feats);
+    __m256i acc = _mm256_setzero_si256();
+    for (int f = 0; f < LINES4_FEATURES; f++) {
+        __m256i count = _mm256_popcnt_epi32(feats[f]);
+        acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(count, _mm256_set1_epi32(lines4_weights[f])));
+    }
+
+    LINES4_STORE(m5, acc, scores);
+    return scores;
+}
+
+#undef LINES4_LOAD
+#undef LINES4_STORE
+#endif
+
+// ==========================================================
+// 运行时内核分派
+// ==========================================================
+
+typedef DualLines (*Lines4Kernel)(Lines4 me, Lines4 enemy, Lines4 mask);
+
+static DualLines evaluateLines4Resolve(Lines4 me, Lines4 enemy, Lines4 mask);
+
+static Lines4Kernel lines4_kernel = evaluateLines4Resolve; // 首次调用时选择内核
+static EvalKernel lines4_kernel_id = EVAL_KERNEL_GENERIC;
+
+static const char *const kernel_names[EVAL_KERNEL_COUNT] = {"generic", "avx2", "avx512"};
+
+static Lines4Kernel kernelFunction(EvalKernel kernel) {
+    switch (kernel) {
+#ifdef EVAL_X86_KERNELS
+        case EVAL_KERNEL_AVX2: return evaluateLines4AVX2;
+        case EVAL_KERNEL_AVX512: return evaluateLines4AVX512;
+#endif
+        case EVAL_KERNEL_GENERIC: return evaluateLines4Generic;
+        default: return NULL;
+    }
+}
+
+int evaluateKernelSupported(EvalKernel kernel) {
+    switch (kernel) {
+        case EVAL_KERNEL_GENERIC: return 1;
+#ifdef EVAL_X86_KERNELS
+        case EVAL_KERNEL_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+        case EVAL_KERNEL_AVX512:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("avx512vl") &&
+                   __builtin_cpu_supports("avx512vpopcntdq");
+#endif
+        default: return 0;
+    }
+}
+
+void evaluateInit(void) {
+    // 环境变量 GOMOKU_KERNEL 可强制指定内核（不支持时忽略）
+    const char *forced = getenv("GOMOKU_KERNEL");
+    if (forced) {
+        for (int k = 0; k < EVAL_KERNEL_COUNT; k++) {
+            if (strcmp(forced, kernel_names[k]) == 0 && evaluateSetKernel((EvalKernel)k)) return;
+        }
+    }
+    // 否则选择当前CPU支持的最快内核
+    for (int k = EVAL_KERNEL_COUNT - 1; k >= 0; k--) {
+        if (evaluateSetKernel((EvalKernel)k)) return;
+    }
+}
+
+int evaluateSetKernel(EvalKernel kernel) {
+    if (kernel < 0 || kernel >= EVAL_KERNEL_COUNT || !evaluateKernelSupported(kernel)) return 0;
+    lines4_kernel_id = kernel;
+    lines4_kernel = kernelFunction(kernel);
+    return 1;
+}
+
+EvalKernel evaluateGetKernel(void) {
+    if (lines4_kernel == evaluateLines4Resolve) evaluateInit();
+    return lines4_kernel_id;
+}
+
+const char *evaluateKernelName(EvalKernel kernel) {
+    if (kernel < 0 || kernel >= EVAL_KERNEL_COUNT) return "unknown";
+    return kernel_names[kernel];
+}
+
+static DualLines evaluateLines4Resolve(Lines4 me, Lines4 enemy, Lines4 mask) {
+    evaluateInit();
+    return lines4_kernel(me, enemy, mask);
+}
+
+DualLines evaluateLines4(Lines4 me, Lines4 enemy, Lines4 mask) {
+    return lines4_kernel(me, enemy, mask);
+}
+
+// --- 落子窗口评估 ---
+
+// 窗口半径：假三过滤 (jump4_1 << 2, jump4_3) 最远会读到锚点两侧共7格，
+// 因此落子点两侧各取6格才能保证所有经过落子点的棋型都完整落在窗口内
+#define WINDOW_RADIUS 6
+#define WINDOW_CELLS_MASK ((1u << (2 * WINDOW_RADIUS + 1)) - 1) // 13格
+#define WINDOW_LANE_BITS 16
+// 每个16位通道的中心位（落子点）
+#define WINDOW_CENTER_BITS (0x0040004000400040ULL)
+
+// 经过落子点的4条线: [列, 行, 主对角线, 副对角线]
+typedef struct {
+    Line b[4];
+    Line w[4];
+    int pos[4];  // 落子点在各线上的位
+    int lens[4]; // 各线长度
+} MoveLines;
+
+static inline void gatherMoveLines(const BitBoardState *board, int row, int col, MoveLines *lines) {
+    int idx_d1 = row - col + (BOARD_SIZE - 1);
+    int idx_d2 = row + col;
+    LinePair pairs[4] = {board->cols[col], board->rows[row], board->diag1[idx_d1], board->diag2[idx_d2]};
+    for (int i = 0; i < 4; i++) {
+        lines->b[i] = pairs[i].black;
+        lines->w[i] = pairs[i].white;
+    }
+    lines->pos[0] = row;
+    lines->pos[1] = col;
+    lines->pos[2] = (row < col) ? row : col;
+    lines->pos[3] = (row < BOARD_SIZE - 1 - col) ? row : BOARD_SIZE - 1 - col;
+    lines->lens[0] = BOARD_SIZE;
+    lines->lens[1] = BOARD_SIZE;
+    lines->lens[2] = BOARD_SIZE - ABS(idx_d1 - (BOARD_SIZE - 1));
+    lines->lens[3] = BOARD_SIZE - ABS(idx_d2 - (BOARD_SIZE - 1));
+}
+
+// 截取以pos为中心的13格窗口，越界部分补0
+static inline unsigned long long windowOf(unsigned int line, int pos) {
+    return ((line << WINDOW_RADIUS) >> pos) & WINDOW_CELLS_MASK;
+}
+
+// 打包4个方向的窗口: [Diag2 | Diag1 | Row | Col]，每个方向16位
+// 长度不足5的对角线与整线评估一致，直接跳过
+static inline void packWindows(const MoveLines *lines, unsigned long long *black, unsigned long long *white,
+                               unsigned long long *cells) {
+    *black = 0; *white = 0; *cells = 0;
+    for (int i = 0; i < 4; i++) {
+        if (lines->lens[i] < 5) continue;
+        int shift = i * WINDOW_LANE_BITS;
+        *black |= windowOf(lines->b[i], lines->pos[i]) << shift;
+        *white |= windowOf(lines->w[i], lines->pos[i]) << shift;
+        *cells |= windowOf((1u << lines->lens[i]) - 1, lines->pos[i]) << shift;
+    }
+}
+
+// 单个窗口字的模式匹配与计分（规则与 evaluateLines4 相同）
+// 返回所有棋型的分数之和（不含计数位），m5 输出五连位
+static inline int windowWordEval(unsigned long long my_line, unsigned long long valid, unsigned long long *m5_out) {
+    unsigned long long mask_0xxxx0 = (valid >> 4) & (valid << 1);
+    unsigned long long mask_axxxxb = (valid >> 4) ^ (valid << 1);
+
+    unsigned long long m2 = my_line & (my_line >> 1);
+    unsigned long long m3 = m2 & (m2 >> 1);
+    unsigned long long m4 = m3 & (m3 >> 1);
+    *m5_out = m4 & (m4 >> 1);
+
+    m2 &= ~(m3 | (m3 << 1));
+
+    unsigned long long live2 = (valid << 1) & m2 & (valid >> 2);
+    unsigned long long rush2 = m2 & ((valid << 1) ^ (valid >> 2));
+    unsigned long long strong_live2 = (valid << 2) & live2 & (valid >> 3);
+
+    unsigned long long jump3_a = my_line & (m2 >> 2) & (valid >> 1);
+    unsigned long long jump3_b = (my_line >> 3) & m2 & (valid >> 2);
+    unsigned long long live_jump3 = (jump3_a | jump3_b) & mask_0xxxx0;
+
+    unsigned long long live4 = m4 & mask_0xxxx0;
+    unsigned long long rush4 = m4 & mask_axxxxb;
+
+    unsigned long long jump4_1 = my_line & (valid >> 1) & (m3 >> 2);
+    unsigned long long jump4_2 = m2 & (valid >> 2) & (m2 >> 3);
+    unsigned long long jump4_3 = m3 & (valid >> 3) & (my_line >> 4);
+    unsigned long long jump4 = jump4_1 | jump4_2 | jump4_3;
+
+    unsigned long long filter = ~(jump4_1 << 2) & ~jump4_3;
+    unsigned long long live3 = (valid << 1) & m3 & (valid >> 3) & filter;
+    unsigned long long rush3 = ((valid << 1) ^ (valid >> 3)) & m3 & filter;
+
+    int score = 0;
+    score += POPCOUNT64(live2) * (SCORE_LIVE_2 >> _SHIFT);
+    score += POPCOUNT64(rush2) * (SCORE_RUSH_2 >> _SHIFT);
+    score += POPCOUNT64(strong_live2) * ((SCORE_STRONG_LIVE_2 - SCORE_LIVE_2) >> _SHIFT);
+    score += POPCOUNT64(live_jump3) * ((SCORE_JUMP_LIVE_3 - SCORE_LIVE_2) >> _SHIFT);
+    score += POPCOUNT64(live3) * (SCORE_LIVE_3 >> _SHIFT);
+    score += POPCOUNT64(rush3) * (SCORE_RUSH_3 >> _SHIFT);
+    score += POPCOUNT64(live4) * ((SCORE_LIVE_4 - 2 * SCORE_RUSH_3) >> _SHIFT);
+    score += POPCOUNT64(rush4) * ((SCORE_RUSH_4 - SCORE_RUSH_3) >> _SHIFT);
+    score += POPCOUNT64(jump4) * (SCORE_RUSH_4 >> _SHIFT);
+    return score;
+}
+
+// 窗口内出现五连时，按整线重新评估落子前后的4条线
+// lines 为落子前的4条线，返回 player 落子后的净分变化
+static int fullLinesDelta(const MoveLines *lines, Player player) {
+    Lines4 after_b = {0, 0}, after_w = {0, 0}, before_b = {0, 0}, before_w = {0, 0}, masks = {0, 0};
+    for (int i = 0; i < 4; i++) {
+        if (lines->lens[i] < 5) continue;
+        int shift = (i & 1) * 32;
+        unsigned long long *ab = (i < 2) ? &after_b.low : &after_b.high;
+        unsigned long long *aw = (i < 2) ? &after_w.low : &after_w.high;
+        unsigned long long *bb = (i < 2) ? &before_b.low : &before_b.high;
+        unsigned long long *bw = (i < 2) ? &before_w.low : &before_w.high;
+        unsigned long long *m = (i < 2) ? &masks.low : &masks.high;
+        Line stone = (Line)(1 << lines->pos[i]);
+        *bb |= (unsigned long long)lines->b[i] << shift;
+        *bw |= (unsigned long long)lines->w[i] << shift;
+        *ab |= (unsigned long long)(lines->b[i] | ((player == PLAYER_BLACK) ? stone : 0)) << shift;
+        *aw |= (unsigned long long)(lines->w[i] | ((player == PLAYER_WHITE) ? stone : 0)) << shift;
+        *m |= ((1ULL << lines->lens[i]) - 1) << shift;
+    }
+
+    DualLines after = evaluateLines4(after_b, after_w, masks);
+    DualLines before = evaluateLines4(before_b, before_w, masks);
+    unsigned long long after_scores[2][4] = {
+        {after.me.low & 0xFFFFFFFF, after.me.low >> 32, after.me.high & 0xFFFFFFFF, after.me.high >> 32},
+        {after.enemy.low & 0xFFFFFFFF, after.enemy.low >> 32, after.enemy.high & 0xFFFFFFFF, after.enemy.high >> 32}};
+    unsigned long long before_scores[2][4] = {
+        {before.me.low & 0xFFFFFFFF, before.me.low >> 32, before.me.high & 0xFFFFFFFF, before.me.high >> 32},
+        {before.enemy.low & 0xFFFFFFFF, before.enemy.low >> 32, before.enemy.high & 0xFFFFFFFF, before.enemy.high >> 32}};
+
+    int score = 0;
+    for (int i = 0; i < 4; i++) {
+        if (lines->lens[i] < 5) continue;
+        score += (int)(after_scores[0][i] >> _SHIFT) - (int)(after_scores[1][i] >> _SHIFT);
+        score -= (int)(before_scores[0][i] >> _SHIFT) - (int)(before_scores[1][i] >> _SHIFT);
+    }
+    return score;
+}
+
+int evaluateWindowDelta(const BitBoardState *board, int row, int col) {
+    MoveLines lines;
+    gatherMoveLines(board, row, col, &lines);
+
+    // 还原落子前的线
+    Player player = ((lines.b[0] >> row) & 1) ? PLAYER_BLACK : PLAYER_WHITE;
+    for (int i = 0; i < 4; i++) {
+        Line stone = (Line)(1 << lines.pos[i]);
+        if (player == PLAYER_BLACK) lines.b[i] &= ~stone;
+        else lines.w[i] &= ~stone;
+    }
+
+    unsigned long long black, white, cells;
+    packWindows(&lines, &black, &white, &cells);
+    unsigned long long stone = cells & WINDOW_CENTER_BITS;
+    unsigned long long valid_before = ~(black | white) & cells;
+    unsigned long long valid_after = valid_before & ~stone;
+
+    // 布局: [黑前, 白前, 黑后, 白后]
+    unsigned long long inputs[4] = {black, white, black, white};
+    unsigned long long valids[4] = {valid_before, valid_before, valid_after, valid_after};
+    inputs[(player == PLAYER_BLACK) ? 2 : 3] |= stone;
+
+    int word_scores[4];
+    unsigned long long m5[4];
+
+    // 双方落子前后共4个字一次评估
+    #pragma omp simd
+    for (int i = 0; i < 4; i++) {
+        word_scores[i] = windowWordEval(inputs[i], valids[i], &m5[i]);
+    }
+
+    if (m5[0] | m5[1] | m5[2] | m5[3]) {
+        return fullLinesDelta(&lines, player);
+    }
+
+    // 窗口外的棋型在落子前后完全相同，相减后抵消
+    return (word_scores[2] - word_scores[0]) - (word_scores[3] - word_scores[1]);
+}
+
+// 每批评估的候选点数，每个候选点6个窗口字
+#define CANDIDATE_BATCH 8
+#define CANDIDATE_WORDS 6
+
+void evaluateCandidates(const BitBoardState *board, const EvalState *eval, const Position *moves, int n,
+                        Player player, CandidateScore *out) {
+    // 每个候选点的6个字: [黑前, 白前, 黑落子, 白落子, 黑(白落子后), 白(黑落子后)]
+    // 黑落子的净分变化 = (黑落子 - 黑前) - (白(黑落子后) - 白前)
+    // 白落子的净分变化 = (黑(白落子后) - 黑前) - (白落子 - 白前)
+    for (int base = 0; base < n; base += CANDIDATE_BATCH) {
+        int batch = (n - base < CANDIDATE_BATCH) ? n - base : CANDIDATE_BATCH;
+        MoveLines lines[CANDIDATE_BATCH];
+        unsigned long long inputs[CANDIDATE_WORDS][CANDIDATE_BATCH];
+        unsigned long long valids[CANDIDATE_WORDS][CANDIDATE_BATCH];
+        int word_scores[CANDIDATE_WORDS][CANDIDATE_BATCH];
+        unsigned long long m5[CANDIDATE_WORDS][CANDIDATE_BATCH];
+
+        // 1. 收集窗口（不修改棋盘）
+        for (int i = 0; i < CANDIDATE_BATCH; i++) {
+            unsigned long long black = 0, white = 0, cells = 0;
+            if (i < batch) {
+                gatherMoveLines(board, moves[base + i].row, moves[base + i].col, &lines[i]);
+                packWindows(&lines[i], &black, &white, &cells);
+            }
+            unsigned long long stone = cells & WINDOW_CENTER_BITS;
+            unsigned long long valid_before = ~(black | white) & cells;
+            unsigned long long valid_after = valid_before & ~stone;
+            inputs[0][i] = black;         valids[0][i] = valid_before;
+            inputs[1][i] = white;         valids[1][i] = valid_before;
+            inputs[2][i] = black | stone; valids[2][i] = valid_after;
+            inputs[3][i] = white | stone; valids[3][i] = valid_after;
+            inputs[4][i] = black;         valids[4][i] = valid_after;
+            inputs[5][i] = white;         valids[5][i] = valid_after;
+        }
+
+        // 2. 一批候选点的所有窗口字一次评估
+        for (int k = 0; k < CANDIDATE_WORDS; k++) {
+            #pragma omp simd
+            for (int i = 0; i < CANDIDATE_BATCH; i++) {
+                word_scores[k][i] = windowWordEval(inputs[k][i], valids[k][i], &m5[k][i]);
+            }
+        }
+
+        // 3. 组合为进攻分与防守分
+        for (int i = 0; i < batch; i++) {
+            int black_move, white_move;
+            if (m5[0][i] | m5[1][i] | m5[2][i] | m5[3][i] | m5[4][i] | m5[5][i]) {
+                // 出现五连时退回整线评估
+                black_move = fullLinesDelta(&lines[i], PLAYER_BLACK);
+                white_move = fullLinesDelta(&lines[i], PLAYER_WHITE);
+            } else {
+                black_move = (word_scores[2][i] - word_scores[0][i]) - (word_scores[5][i] - word_scores[1][i]);
+                white_move = (word_scores[4][i] - word_scores[0][i]) - (word_scores[3][i] - word_scores[1][i]);
+            }
+
+            CandidateScore *c = &out[base + i];
+            if (player == PLAYER_BLACK) {
+                c->attack = eval->total_score + black_move;
+                c->defence = -white_move;
+            } else {
+                c->attack = -(eval->total_score + white_move);
+                c->defence = black_move;
+            }
+        }
+    }
+}
+
 // --- ai 初始化 Helpers ---
 
 // 一次并行算两lines
@@ -332,6 +820,113 @@ unsigned long long evaluateLines2(Line me1, Line enemy1, int len1, Line me2, Lin
     return score;
 }
 
+// --- 全盘扫描 ---
+
+// 长度不小于5的线: 15列 + 15行 + 21条主对角线 + 21条副对角线
+#define SCAN_LINES (2 * BOARD_SIZE + 2 * (2 * BOARD_SIZE - 9))
+
+void scanBoard(const BitBoardState *board, EvalState *eval) {
+    // 1. 打包: 每条线一个64位字，黑方视角 [白 | 黑]，白方视角 [黑 | 白]
+    unsigned long long me[SCAN_LINES], enemy[SCAN_LINES], masks[SCAN_LINES];
+    unsigned char dirs[SCAN_LINES], idxs[SCAN_LINES];
+    int n = 0;
+    for (int dir = 0; dir < 4; dir++) {
+        const LinePair *pairs;
+        int count = (dir < 2) ? BOARD_SIZE : 2 * BOARD_SIZE - 1;
+        switch (dir) {
+            case 0: pairs = board->cols; break;
+            case 1: pairs = board->rows; break;
+            case 2: pairs = board->diag1; break;
+            default: pairs = board->diag2; break;
+        }
+        for (int i = 0; i < count; i++) {
+            int len = (dir < 2) ? BOARD_SIZE : BOARD_SIZE - ABS(i - (BOARD_SIZE - 1));
+            if (len < 5) continue;
+            unsigned long long m = (1ULL << len) - 1;
+            me[n] = (unsigned long long)pairs[i].black | ((unsigned long long)pairs[i].white << 32);
+            enemy[n] = (unsigned long long)pairs[i].white | ((unsigned long long)pairs[i].black << 32);
+            masks[n] = m | (m << 32);
+            dirs[n] = (unsigned char)dir;
+            idxs[n] = (unsigned char)i;
+            n++;
+        }
+    }
+
+    // 2. 72个字一次向量化评估，每个32位半字的打包分数与 evaluateLines2 一致
+    unsigned int b_scores[SCAN_LINES], w_scores[SCAN_LINES];
+    #pragma omp simd
+    for (int i = 0; i < SCAN_LINES; i++) {
+        unsigned long long my_line = me[i];
+        unsigned long long valid = ~(me[i] | enemy[i]) & masks[i];
+
+        unsigned long long mask_0xxxx0 = (valid >> 4) & (valid << 1);
+        unsigned long long mask_axxxxb = (valid >> 4) ^ (valid << 1);
+
+        unsigned long long m2 = my_line & (my_line >> 1);
+        unsigned long long m3 = m2 & (m2 >> 1);
+        unsigned long long m4 = m3 & (m3 >> 1);
+        unsigned long long m5 = m4 & (m4 >> 1);
+
+        m2 &= ~(m3 | (m3 << 1));
+
+        unsigned long long live2 = (valid << 1) & m2 & (valid >> 2);
+        unsigned long long rush2 = m2 & ((valid << 1) ^ (valid >> 2));
+        unsigned long long strong_live2 = (valid << 2) & live2 & (valid >> 3);
+
+        unsigned long long jump3_a = my_line & (m2 >> 2) & (valid >> 1);
+        unsigned long long jump3_b = (my_line >> 3) & m2 & (valid >> 2);
+        unsigned long long live_jump3 = (jump3_a | jump3_b) & mask_0xxxx0;
+
+        unsigned long long live4 = m4 & mask_0xxxx0;
+        unsigned long long rush4 = m4 & mask_axxxxb;
+
+        unsigned long long jump4_1 = my_line & (valid >> 1) & (m3 >> 2);
+        unsigned long long jump4_2 = m2 & (valid >> 2) & (m2 >> 3);
+        unsigned long long jump4_3 = m3 & (valid >> 3) & (my_line >> 4);
+        unsigned long long jump4 = jump4_1 | jump4_2 | jump4_3;
+
+        unsigned long long filter = ~(jump4_1 << 2) & ~jump4_3;
+        unsigned long long live3 = (valid << 1) & m3 & (valid >> 3) & filter;
+        unsigned long long rush3 = ((valid << 1) ^ (valid >> 3)) & m3 & filter;
+
+        unsigned int lo = 0, hi = 0;
+        #define ACC(feats, score_val) \
+            lo += (unsigned int)POPCOUNT64(feats & 0xFFFFFFFF) * (unsigned int)(score_val); \
+            hi += (unsigned int)POPCOUNT64(feats >> 32) * (unsigned int)(score_val);
+
+        ACC(live2, SCORE_LIVE_2);
+        ACC(rush2, SCORE_RUSH_2);
+        ACC(strong_live2, (SCORE_STRONG_LIVE_2 - SCORE_LIVE_2));
+        ACC(live_jump3, (SCORE_JUMP_LIVE_3 - SCORE_LIVE_2));
+        ACC(live3, SCORE_LIVE_3);
+        ACC(rush3, SCORE_RUSH_3);
+        ACC(live4, (SCORE_LIVE_4 - 2 * SCORE_RUSH_3));
+        ACC(rush4, (SCORE_RUSH_4 - SCORE_RUSH_3));
+        ACC(jump4, SCORE_RUSH_4);
+
+        #undef ACC
+
+        // 五连: 与 evaluateLines2 相同，只给成五的一方记 SCORE_FIVE，另一方记0
+        unsigned int five_lo = (m5 & 0xFFFFFFFFULL) ? (unsigned int)SCORE_FIVE : 0;
+        unsigned int five_hi = (m5 >> 32) ? (unsigned int)SCORE_FIVE : 0;
+        b_scores[i] = m5 ? five_lo : lo;
+        w_scores[i] = m5 ? five_hi : hi;
+    }
+
+    // 3. 写入 EvalState
+    memset(eval, 0, sizeof(*eval));
+    for (int i = 0; i < n; i++) {
+        int net = (int)(b_scores[i] >> _SHIFT) - (int)(w_scores[i] >> _SHIFT);
+#if EVAL_BACKEND == EVAL_BACKEND_WINDOW
+        // 窗口后端只维护总分
+        (void)dirs; (void)idxs;
+#else
+        eval->line_net_scores[dirs[i]][idxs[i]] = net;
+#endif
+        eval->total_score += net;
+    }
+}
+
 // 弃用api
 // // 总分初始化api
 // int evaluateBoard(const BitBoardState *bitBoard, Player player) {
@@ -1,49 +1,68 @@
-#include <stdlib.h>
-#include <string.h>
 #include "../include/history.h"
+#include "../include/bitboard.h"
+#include "../include/renju.h"
 
-//当前状态进栈
-void pushState(GameState *game) {
-    HistoryNode *node = (HistoryNode *)malloc(sizeof(HistoryNode));
-    if (!node) return; 
-
-    // Copy
-    memcpy(node->board, game->board, sizeof(game->board));
-    node->bitBoard = game->bitBoard; 
-    node->currentPlayer = game->currentPlayer;
-    node->lastMove = game->lastMove;
-    node->moveCount = game->moveCount;
-    
-    // Push
-    node->next = game->historyHead;
-    game->historyHead = node;
+// 在 (row, col) 放上或拿掉一枚棋子后，更新禁手位图
+static void refreshForbidden(GameState *game, int row, int col) {
+    forbiddenMapTouch(&game->forbidden, row, col);
+    if (game->ruleType == RULE_STANDARD) {
+        forbiddenMapResolve(&game->forbidden, &game->bitBoard, board256Full());
+    }
 }
 
-//悔棋出栈
+//记录一步棋
+void pushMove(GameState *game, int row, int col) {
+    GameHistory *h = &game->history;
+    if (h->count >= BOARD_SIZE * BOARD_SIZE) return;
+
+    HistoryEntry *e = &h->moves[h->count++];
+    e->row = (signed char)row;
+    e->col = (signed char)col;
+    e->prevRow = (signed char)game->lastMove.row;
+    e->prevCol = (signed char)game->lastMove.col;
+    e->player = (signed char)game->currentPlayer;
+    h->top = h->count;
+}
+
+//悔棋：按记录回退一步
 int undoMove(GameState *game) {
-    if (!game->historyHead) {
+    GameHistory *h = &game->history;
+    if (h->count == 0) {
         return 0; // Empty
     }
 
-    HistoryNode *node = game->historyHead;
-    game->historyHead = node->next;
+    const HistoryEntry *e = &h->moves[--h->count];
+    undoBitBoard(&game->bitBoard, e->row, e->col, (Player)e->player);
+    refreshForbidden(game, e->row, e->col);
+
+    game->currentPlayer = (Player)e->player;
+    game->lastMove.row = e->prevRow;
+    game->lastMove.col = e->prevCol;
+    game->moveCount--;
+    return 1;
+}
 
-    // Restore state
-    memcpy(game->board, node->board, sizeof(node->board));
-    game->bitBoard = node->bitBoard;
-    game->currentPlayer = node->currentPlayer;
-    game->lastMove = node->lastMove;
-    game->moveCount = node->moveCount;
+//重做：重新落下最近悔掉的一步
+int redoMove(GameState *game) {
+    GameHistory *h = &game->history;
+    if (h->count >= h->top) {
+        return 0;
+    }
 
-    free(node);
+    const HistoryEntry *e = &h->moves[h->count++];
+    Player player = (Player)e->player;
+    updateBitBoard(&game->bitBoard, e->row, e->col, player);
+    refreshForbidden(game, e->row, e->col);
+
+    game->currentPlayer = (player == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK;
+    game->lastMove.row = e->row;
+    game->lastMove.col = e->col;
+    game->moveCount++;
     return 1;
 }
 
 //清空历史记录
 void clearHistory(GameState *game) {
-    while (game->historyHead) {
-        HistoryNode *temp = game->historyHead;
-        game->historyHead = temp->next;
-        free(temp);
-    }
+    game->history.count = 0;
+    game->history.top = 0;
 }
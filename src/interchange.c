@@ -0,0 +1,375 @@
+#include "../include/interchange.h"
+#include "../include/record.h"
+#include "../include/board.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// RenLib 节点标志
+#define RENLIB_DOWN 0x80
+#define RENLIB_RIGHT 0x40
+#define RENLIB_OLD_COMMENT 0x20
+#define RENLIB_MARK 0x10
+#define RENLIB_COMMENT 0x08
+#define RENLIB_START 0x04
+#define RENLIB_NO_MOVE 0x02
+#define RENLIB_EXTENSION 0x01
+#define RENLIB_HEADER_SIZE 20
+
+static const unsigned char renlib_header[RENLIB_HEADER_SIZE] = {
+    0xFF, 'R', 'e', 'n', 'L', 'i', 'b', 0xFF, 3, 0, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+#define MAX_MOVES (BOARD_SIZE * BOARD_SIZE)
+
+GameFormat formatFromPath(const char *path) {
+    const char *ext = strrchr(path, '.');
+    if (!ext) return FORMAT_UNKNOWN;
+    if (strcmp(ext, ".txt") == 0) return FORMAT_RECORD;
+    if (strcmp(ext, ".gmb") == 0) return FORMAT_CORPUS;
+    if (strcmp(ext, ".psq") == 0) return FORMAT_PSQ;
+    if (strcmp(ext, ".pos") == 0) return FORMAT_POSLIST;
+    if (strcmp(ext, ".lib") == 0) return FORMAT_RENLIB;
+    return FORMAT_UNKNOWN;
+}
+
+// 导入过程的公共状态
+typedef struct {
+    RuleType rule;
+    GameSink sink;
+    void *user;
+    long long delivered;
+    long long rejected;
+    int stopped;
+} Importer;
+
+// 检查一盘棋（坐标越界、重复落子）后交给 sink
+static void deliver(Importer *im, const unsigned char *moves, int count, RuleType rule) {
+    unsigned char seen[MAX_MOVES] = {0};
+    if (count <= 0 || im->stopped) return;
+    for (int i = 0; i < count; i++) {
+        if (moves[i] >= MAX_MOVES || seen[moves[i]]) {
+            im->rejected++;
+            return;
+        }
+        seen[moves[i]] = 1;
+    }
+    CorpusGame game = {moves, count, rule, CORPUS_RESULT_UNKNOWN};
+    im->delivered++;
+    if (!im->sink(im->user, &game)) im->stopped = 1;
+}
+
+static int importRecord(Importer *im, FILE *fp) {
+    Position pos[MAX_MOVES];
+    unsigned char moves[MAX_MOVES];
+    int count;
+    for (;;) {
+        GameMode mode = MODE_PVE;
+        RuleType rule = im->rule;
+        if (!recordReadGame(fp, &mode, &rule, pos, &count) || im->stopped) break;
+        for (int i = 0; i < count; i++) moves[i] = CORPUS_MOVE(pos[i].row, pos[i].col);
+        deliver(im, moves, count, rule);
+    }
+    return 1;
+}
+
+static int importPsq(Importer *im, FILE *fp) {
+    char line[256];
+    unsigned char moves[MAX_MOVES];
+    int count = 0;
+    int in_game = 0;   // 正在读走法行
+    int bad = 0;       // 当前这盘棋有越界坐标或棋盘大小不是15
+    while (!im->stopped && fgets(line, sizeof(line), fp)) {
+        int x, y;
+        if (strncmp(line, "Piskvork", 8) == 0) {
+            // 上一盘棋后面直接接着下一盘，同样要检查上一盘是否有效
+            if (in_game && bad) im->rejected++;
+            else if (in_game) deliver(im, moves, count, im->rule);
+            int w = 0, h = 0;
+            sscanf(line + 8, " %dx%d", &w, &h);
+            in_game = 1;
+            count = 0;
+            bad = (w != BOARD_SIZE || h != BOARD_SIZE);
+        } else if (in_game && sscanf(line, "%d,%d", &x, &y) == 2) {
+            if (x < 1 || x > BOARD_SIZE || y < 1 || y > BOARD_SIZE || count >= MAX_MOVES) bad = 1;
+            else moves[count++] = CORPUS_MOVE(y - 1, x - 1);
+        } else if (in_game) {
+            // 走法后面是结果与双方程序名等信息，这盘棋到此结束
+            if (bad) im->rejected++;
+            else deliver(im, moves, count, im->rule);
+            in_game = 0;
+        }
+    }
+    if (in_game) {
+        if (bad) im->rejected++;
+        else deliver(im, moves, count, im->rule);
+    }
+    return 1;
+}
+
+static int importPositionList(Importer *im, FILE *fp) {
+    unsigned char moves[MAX_MOVES];
+    int count = 0, bad = 0;
+    int col = -1, row = 0, digits = 0;
+    int line_start = 1;
+    int c;
+    while (!im->stopped) {
+        c = getc(fp);
+        if (line_start && c == '#') {
+            while (c != EOF && c != '\n') c = getc(fp);
+        }
+        line_start = 0;
+
+        // 一个走法在列字母后的数字结束时完成
+        if (col >= 0 && !(digits < 2 && isdigit(c))) {
+            if (digits == 0 || row < 1 || row > BOARD_SIZE || count >= MAX_MOVES) bad = 1;
+            else moves[count++] = CORPUS_MOVE(BOARD_SIZE - row, col);
+            col = -1;
+        }
+        if (c == EOF || c == '\n') {
+            if (bad) im->rejected++;
+            else deliver(im, moves, count, im->rule);
+            count = 0;
+            bad = 0;
+            line_start = 1;
+            if (c == EOF) break;
+        } else if (col >= 0) {
+            row = row * 10 + (c - '0');
+            digits++;
+        } else if (isalpha(c)) {
+            col = tolower(c) - 'a';
+            if (col >= BOARD_SIZE) bad = 1;
+            row = 0;
+            digits = 0;
+        } else if (!isspace(c) && c != ',' && c != ';') {
+            bad = 1;
+        }
+    }
+    return 1;
+}
+
+// 跳过以 '\0' 结尾的字符串，文件提前结束时返回0
+static int skipString(FILE *fp) {
+    int c;
+    while ((c = getc(fp)) != EOF) {
+        if (c == 0) return 1;
+    }
+    return 0;
+}
+
+static int importRenLib(Importer *im, FILE *fp) {
+    unsigned char header[RENLIB_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), fp) != sizeof(header) || memcmp(header, renlib_header, 8) != 0) {
+        fprintf(stderr, "renlib: bad header\n");
+        return 0;
+    }
+
+    // path[d] 是第 d 层当前节点的走法（空着记为 MAX_MOVES），pending 保存还有兄弟节点未读的层
+    unsigned char path[MAX_MOVES];
+    unsigned char moves[MAX_MOVES];
+    int pending[MAX_MOVES];
+    int npending = 0;
+    int depth = 0;
+    unsigned char node[2];
+    while (!im->stopped && fread(node, 1, 2, fp) == 2) {
+        int pos = node[0], flags = node[1];
+        if (depth >= MAX_MOVES) {
+            fprintf(stderr, "renlib: tree is deeper than the board\n");
+            return 0;
+        }
+        if (pos == 0 || (flags & RENLIB_NO_MOVE)) {
+            path[depth] = MAX_MOVES;
+        } else {
+            int c = (pos & 0x0F) - 1, r = pos >> 4;
+            path[depth] = (c >= 0 && c < BOARD_SIZE && r < BOARD_SIZE) ? CORPUS_MOVE(r, c) : MAX_MOVES + 1;
+        }
+        if ((flags & RENLIB_COMMENT) && !skipString(fp)) break;
+        if ((flags & RENLIB_OLD_COMMENT) && !skipString(fp)) break;
+        if ((flags & RENLIB_EXTENSION) && fseek(fp, 4, SEEK_CUR) != 0) break;
+
+        if (flags & RENLIB_DOWN) {
+            if (flags & RENLIB_RIGHT) pending[npending++] = depth;
+            depth++;
+            continue;
+        }
+
+        // 叶子：输出根到这里的路径（去掉空着）
+        int count = 0;
+        for (int d = 0; d <= depth; d++) {
+            if (path[d] != MAX_MOVES) moves[count++] = path[d];
+        }
+        deliver(im, moves, count, im->rule);
+
+        if (flags & RENLIB_RIGHT) continue;
+        if (npending == 0) break;
+        depth = pending[--npending];
+    }
+    return 1;
+}
+
+long long importGames(FILE *fp, GameFormat format, RuleType rule, GameSink sink, void *user, long long *rejected) {
+    Importer im = {rule, sink, user, 0, 0, 0};
+    int ok;
+    switch (format) {
+        case FORMAT_RECORD: ok = importRecord(&im, fp); break;
+        case FORMAT_PSQ: ok = importPsq(&im, fp); break;
+        case FORMAT_POSLIST: ok = importPositionList(&im, fp); break;
+        case FORMAT_RENLIB: ok = importRenLib(&im, fp); break;
+        default: ok = 0; break;
+    }
+    if (rejected) *rejected = im.rejected;
+    return ok ? im.delivered : -1;
+}
+
+int exporterOpen(GameExporter *exporter, const char *path, GameFormat format) {
+    memset(exporter, 0, sizeof(*exporter));
+    exporter->format = format;
+    if (format == FORMAT_CORPUS) return corpusWriterOpen(&exporter->corpus, path);
+    if (format == FORMAT_UNKNOWN) return 0;
+
+    exporter->fp = fopen(path, (format == FORMAT_RENLIB) ? "wb" : "w");
+    if (!exporter->fp) {
+        perror("export");
+        return 0;
+    }
+    if (format == FORMAT_RENLIB) {
+        return fwrite(renlib_header, 1, sizeof(renlib_header), exporter->fp) == sizeof(renlib_header);
+    }
+    return 1;
+}
+
+// 给已写出的第 depth 层节点补上标志
+static int renlibPatch(GameExporter *exporter, int depth, int flag) {
+    long end = ftell(exporter->fp);
+    exporter->last_flags[depth] |= flag;
+    return fseek(exporter->fp, exporter->last_offsets[depth] + 1, SEEK_SET) == 0 &&
+           putc(exporter->last_flags[depth], exporter->fp) != EOF &&
+           fseek(exporter->fp, end, SEEK_SET) == 0;
+}
+
+static int renlibAdd(GameExporter *exporter, const CorpusGame *game) {
+    int count = game->move_count;
+    int k = 0;
+    while (k < count && k < exporter->last_count && game->moves[k] == exporter->last_moves[k]) k++;
+    // 与上一盘相同或是它的前缀，树中已经有这条路径
+    if (k == count) return 1;
+
+    if (exporter->last_count > 0) {
+        int ok = (k == exporter->last_count) ? renlibPatch(exporter, k - 1, RENLIB_DOWN)
+                                             : renlibPatch(exporter, k, RENLIB_RIGHT);
+        if (!ok) return 0;
+    }
+    for (int d = k; d < count; d++) {
+        unsigned char m = game->moves[d];
+        unsigned char node[2];
+        node[0] = (unsigned char)((CORPUS_COL(m) + 1) | (CORPUS_ROW(m) << 4));
+        node[1] = (d + 1 < count) ? RENLIB_DOWN : 0;
+        exporter->last_moves[d] = m;
+        exporter->last_offsets[d] = ftell(exporter->fp);
+        exporter->last_flags[d] = node[1];
+        if (fwrite(node, 1, 2, exporter->fp) != 2) return 0;
+    }
+    exporter->last_count = count;
+    return 1;
+}
+
+int exporterAdd(GameExporter *exporter, const CorpusGame *game) {
+    FILE *fp = exporter->fp;
+    int ok = 1;
+    switch (exporter->format) {
+        case FORMAT_CORPUS:
+            ok = corpusWriterAdd(&exporter->corpus, game->moves, game->move_count, game->rule, game->result);
+            break;
+        case FORMAT_RECORD: {
+            GameState state;
+            char name[32];
+            if (!corpusReplay(&state, game)) return 0;
+            snprintf(name, sizeof(name), "game %lld", exporter->game_count + 1);
+            ok = recordWrite(&state, fp, name);
+            break;
+        }
+        case FORMAT_PSQ:
+            fprintf(fp, "Piskvork %dx%d, 11:11, 0\n", BOARD_SIZE, BOARD_SIZE);
+            for (int i = 0; i < game->move_count; i++) {
+                fprintf(fp, "%d,%d,0\n", CORPUS_COL(game->moves[i]) + 1, CORPUS_ROW(game->moves[i]) + 1);
+            }
+            fprintf(fp, "-1\n");
+            break;
+        case FORMAT_POSLIST:
+            for (int i = 0; i < game->move_count; i++) {
+                fprintf(fp, "%c%d", 'a' + CORPUS_COL(game->moves[i]), BOARD_SIZE - CORPUS_ROW(game->moves[i]));
+            }
+            putc('\n', fp);
+            break;
+        case FORMAT_RENLIB:
+            ok = renlibAdd(exporter, game);
+            break;
+        default:
+            return 0;
+    }
+    if (fp && ferror(fp)) ok = 0;
+    if (ok) exporter->game_count++;
+    return ok;
+}
+
+int exporterClose(GameExporter *exporter) {
+    int ok = 1;
+    if (exporter->format == FORMAT_CORPUS) ok = corpusWriterClose(&exporter->corpus);
+    else if (exporter->fp) ok = (fclose(exporter->fp) == 0);
+    exporter->fp = NULL;
+    return ok;
+}
+
+static int exportSink(void *user, const CorpusGame *game) {
+    return exporterAdd((GameExporter *)user, game);
+}
+
+int convertGames(const char *in, const char *out, RuleType rule) {
+    GameFormat in_format = formatFromPath(in);
+    GameFormat out_format = formatFromPath(out);
+    if (in_format == FORMAT_UNKNOWN || out_format == FORMAT_UNKNOWN) {
+        fprintf(stderr, "convert: unknown format, use .txt .gmb .psq .pos or .lib\n");
+        return 0;
+    }
+
+    GameExporter exporter;
+    if (!exporterOpen(&exporter, out, out_format)) {
+        fprintf(stderr, "convert: cannot create %s\n", out);
+        return 0;
+    }
+
+    long long games = 0, rejected = 0;
+    if (in_format == FORMAT_CORPUS) {
+        Corpus corpus;
+        if (!corpusOpen(&corpus, in)) {
+            exporterClose(&exporter);
+            return 0;
+        }
+        for (unsigned long long i = 0; i < corpus.game_count; i++) {
+            CorpusGame game;
+            if (!corpusGame(&corpus, i, &game)) {
+                rejected++;
+                continue;
+            }
+            if (!exporterAdd(&exporter, &game)) break;
+            games++;
+        }
+        corpusClose(&corpus);
+    } else {
+        FILE *fp = fopen(in, (in_format == FORMAT_RENLIB) ? "rb" : "r");
+        if (!fp) {
+            fprintf(stderr, "convert: cannot open %s\n", in);
+            exporterClose(&exporter);
+            return 0;
+        }
+        games = importGames(fp, in_format, rule, exportSink, &exporter, &rejected);
+        fclose(fp);
+    }
+
+    int ok = exporterClose(&exporter) && games >= 0;
+    printf("convert: %lld games written to %s, %lld invalid games skipped\n",
+           games < 0 ? 0 : exporter.game_count, out, rejected);
+    return ok;
+}
@@ -0,0 +1,108 @@
+#include "../include/linetable.h"
+#include "../include/evaluate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const int *line_table[BOARD_SIZE + 1];
+unsigned int line_tern_lo[256];
+unsigned int line_tern_hi[128];
+
+static void *map_base = NULL;  // mmap 起始地址
+static size_t map_size = 0;
+
+void lineTableInitIndex(void) {
+    // 3^8 = 6561，高7位的权重从 3^8 起
+    for (int m = 0; m < 256; m++) {
+        unsigned int t = 0, p = 1;
+        for (int i = 0; i < 8; i++, p *= 3) {
+            if (m & (1 << i)) t += p;
+        }
+        line_tern_lo[m] = t;
+        if (m < 128) line_tern_hi[m] = t * 6561;
+    }
+}
+
+unsigned int lineTableOffset(int len) {
+    // 子表依次存放长度 5, 6, ..., 15，len == 16 时返回总项数
+    unsigned int offset = 0, size = 1;
+    for (int l = 0; l < len; l++) {
+        if (l >= LINE_TABLE_MIN_LEN) offset += size;
+        size *= 3;
+    }
+    return offset;
+}
+
+int lineTableComputeEntry(Line b, Line w, int len) {
+    // 与 initEvalState 中的单线评估保持一致：黑方视角与白方视角各算一次
+    unsigned long long scores = evaluateLines2(b, w, len, w, b, len);
+    int b_packed = (int)(scores & 0xFFFFFFFF);
+    int w_packed = (int)(scores >> 32);
+    int net = (b_packed >> _SHIFT) - (w_packed >> _SHIFT);
+    // 低 _SHIFT 位保留黑方的四/活三计数，便于禁手判断
+    return net * (1 << _SHIFT) + (b_packed & ((1 << _SHIFT) - 1));
+}
+
+int lineTableLoad(const char *path) {
+    if (map_base) return 1;
+    if (!path) path = getenv("GOMOKU_LINETABLE");
+    if (!path) path = LINE_TABLE_PATH;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "line table: cannot open %s\n", path);
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(LineTableHeader)) {
+        close(fd);
+        fprintf(stderr, "line table: %s is truncated\n", path);
+        return 0;
+    }
+    void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("line table: mmap");
+        return 0;
+    }
+
+    // 校验文件头
+    const LineTableHeader *header = (const LineTableHeader *)base;
+    unsigned int total = lineTableOffset(BOARD_SIZE + 1);
+    if (header->magic != LINE_TABLE_MAGIC || header->version != LINE_TABLE_VERSION ||
+        header->entry_count != total ||
+        (size_t)st.st_size < sizeof(LineTableHeader) + (size_t)total * sizeof(int)) {
+        munmap(base, st.st_size);
+        fprintf(stderr, "line table: %s has a bad header, rebuild it with `make table`\n", path);
+        return 0;
+    }
+
+    lineTableInitIndex();
+    const int *entries = (const int *)((const char *)base + sizeof(LineTableHeader));
+    for (int len = LINE_TABLE_MIN_LEN; len <= BOARD_SIZE; len++) {
+        line_table[len] = entries + header->offsets[len];
+    }
+    // 查表访问是随机的，关闭预读
+    madvise(base, st.st_size, MADV_RANDOM);
+
+    map_base = base;
+    map_size = st.st_size;
+    return 1;
+}
+
+void lineTableFree(void) {
+    if (map_base) {
+        munmap(map_base, map_size);
+        map_base = NULL;
+        map_size = 0;
+        memset(line_table, 0, sizeof(line_table));
+    }
+}
+
+int lineTableReady(void) {
+    return map_base != NULL;
+}
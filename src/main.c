@@ -138,7 +138,11 @@
 #include "../include/ai.h"
 #include "../include/start_helper.h"
 #include "../include/record.h"
-#include "../include/tt.h" //悔棋时使用
+#include "../include/interchange.h"
+#include "../include/annotate.h"
+#include "../include/protocol.h"
+#include "../include/serve.h"
+#include "../include/engine.h"
 
 void printHelp() {
     printf("Usage: gomoku [options]\n");
@@ -147,6 +151,22 @@ void printHelp() {
     printf("  --rules <std|simple>  Set rules (default: std)\n");
     printf("  --debug renju         Enable Renju debug mode (Black only, type 'white' to switch)\n");
     printf("  --load <File_Name>    load endgame\n");
+    printf("  --convert <in> <out>  Convert game records between .txt .gmb .psq .pos .lib\n");
+    printf("  --protocol gomocup    Run as a Gomocup/Piskvork engine on stdin/stdout\n");
+    printf("  --annotate <files...> Annotate every position of the given records, writing <file>.ann\n");
+    printf("    --depth <n>         Search depth per position (default: 8)\n");
+    printf("    --nodes <n>         Node budget per position (default: unlimited)\n");
+    printf("    --movetime <ms>     Time budget per position (default: unlimited)\n");
+    printf("    --threads <n>       Worker threads (default: all cores)\n");
+    printf("    --hash <MB>         Transposition table size per thread (default: 16)\n");
+    printf("    --blunder <score>   Loss that marks a blunder (default: 2000)\n");
+    printf("  --serve <address>     Serve JSON analysis requests on unix:<path> or [127.0.0.1:]<port> (HTTP)\n");
+    printf("    --depth, --nodes, --movetime  Default limits of a request (default: depth 8)\n");
+    printf("    --threads <n>       Engines in the pool (default: all cores)\n");
+    printf("    --hash <MB>         Transposition table size per engine (default: 16)\n");
+    printf("    --book <file>       Opening book built from a game record (may be repeated)\n");
+    printf("    --book-ply <n>      Plies of each game kept in the book (default: 12)\n");
+    printf("    --queue <n>         Queued requests before answering busy (default: 1024)\n");
 }
 
 //调库实现stdin
@@ -194,6 +214,15 @@ int main(int argc, char *argv[]) {
     int forceWhite = 0;
     int loadflag = 0;//加载棋谱的标记
     char filename[255];
+    const char *convertIn = NULL, *convertOut = NULL;
+    int gomocup = 0;//以 Gomocup 协议运行
+    char **annotatePaths = NULL;//--annotate 之后的文件列表
+    int annotateCount = 0;
+    AnnotateOptions annotate;
+    annotateDefaults(&annotate);
+    ServeOptions serve;//--serve，搜索限制、线程数与置换表大小沿用 --annotate 的选项
+    serveDefaults(&serve);
+    char *bookPaths[argc];//每个 --book 占两个参数，数组一定放得下
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
             if (strcmp(argv[i+1], "pve") == 0) mode = MODE_PVE;
@@ -215,8 +244,62 @@ int main(int argc, char *argv[]) {
         } else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc){
             strcpy(filename, argv[i+1]);
             loadflag = 1;
+        } else if (strcmp(argv[i], "--convert") == 0 && i + 2 < argc) {
+            convertIn = argv[i+1];
+            convertOut = argv[i+2];
+            i += 2;
+        } else if (strcmp(argv[i], "--protocol") == 0 && i + 1 < argc) {
+            if (strcmp(argv[i+1], "gomocup") == 0) gomocup = 1;
+            i++;
+        } else if (strcmp(argv[i], "--annotate") == 0) {
+            annotatePaths = &argv[i+1];
+            while (i + 1 < argc && strncmp(argv[i+1], "--", 2) != 0) {
+                annotateCount++;
+                i++;
+            }
+        } else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            annotate.max_depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--nodes") == 0 && i + 1 < argc) {
+            annotate.max_nodes = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--movetime") == 0 && i + 1 < argc) {
+            annotate.max_time = atoi(argv[++i]) / 1000.0;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            annotate.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--hash") == 0 && i + 1 < argc) {
+            annotate.tt_mb = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--blunder") == 0 && i + 1 < argc) {
+            annotate.blunder = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            serve.address = argv[++i];
+        } else if (strcmp(argv[i], "--book") == 0 && i + 1 < argc) {
+            bookPaths[serve.book_count++] = argv[++i];
+        } else if (strcmp(argv[i], "--book-ply") == 0 && i + 1 < argc) {
+            serve.book_ply = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--queue") == 0 && i + 1 < argc) {
+            serve.queue_limit = atoi(argv[++i]);
         }
     }
+    // 批量转换棋谱后直接退出，--rules 指定不带规则信息的格式所用的规则
+    if (convertIn) {
+        return convertGames(convertIn, convertOut, rule) ? 0 : 1;
+    }
+    if (gomocup) {
+        return runGomocupProtocol(rule) ? 0 : 1;
+    }
+    if (serve.address) {
+        serve.rule = rule;
+        serve.max_depth = annotate.max_depth;
+        serve.max_nodes = annotate.max_nodes;
+        serve.max_time = annotate.max_time;
+        serve.workers = annotate.threads;
+        serve.tt_mb = annotate.tt_mb;
+        serve.book_paths = bookPaths;
+        return runServer(&serve) ? 0 : 1;
+    }
+    if (annotatePaths) {
+        annotate.rule = rule;
+        return annotateFiles(annotatePaths, annotateCount, &annotate) ? 0 : 1;
+    }
     GameState game;
     if(loadflag == 0){
         initGame(&game, mode, rule);
@@ -303,7 +386,8 @@ int main(int argc, char *argv[]) {
             printf("Next move set to White.\n");
             continue;
         } else if (strcmp(input, "undo") == 0) {
-            tt_clear();//只清理一次
+            Engine *ai = engine_default_if_created();//PvP 下没有引擎就不必为了清理而创建
+            if (ai) engine_clear(ai);//只清理一次
             if (undoMove(&game)) {
                 system("clear");
                 // PvE就悔棋两次以回到玩家执棋
@@ -316,6 +400,21 @@ int main(int argc, char *argv[]) {
                 printf("Cannot undo.\n");
             }
             continue;
+        } else if (strcmp(input, "redo") == 0) {
+            Engine *ai = engine_default_if_created();
+            if (ai) engine_clear(ai);
+            if (redoMove(&game)) {
+                system("clear");
+                // PvE同样重做两次，回到玩家执棋
+                if (mode == MODE_PVE) {
+                    redoMove(&game);
+                }
+                printBoard(&game);
+                printf("Redo successful.\n");
+            } else {
+                printf("Cannot redo.\n");
+            }
+            continue;
         }
 
         int r, c;
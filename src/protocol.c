@@ -0,0 +1,244 @@
+#include "../include/protocol.h"
+#include "../include/board.h"
+#include "../include/rules.h"
+#include "../include/renju.h"
+#include "../include/ai.h"
+#include "../include/engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdarg.h>
+
+// 未收到 max_memory（或为0）时的置换表大小
+#define PROTOCOL_DEFAULT_TT_MB 64
+// 置换表最多占用 max_memory 的一半，其余留给程序本身
+#define PROTOCOL_TT_SHARE 2
+// 每步预留的时间余量（毫秒）与按剩余时间分配时假设的剩余步数
+#define PROTOCOL_TIME_MARGIN_MS 30
+#define PROTOCOL_MOVES_TO_GO 25
+#define PROTOCOL_GOMOCUP_RULE_RENJU 4
+// 管理程序没有发送 timeout_turn 时的每步时间（毫秒）
+#define PROTOCOL_DEFAULT_TURN_MS 5000
+
+typedef struct {
+    Engine *engine; // 对局状态与置换表
+    RuleType rule;
+    long long timeout_turn;  // 毫秒，0 表示尽快走
+    long long timeout_match; // 毫秒，0 表示不限
+    long long time_left;     // 毫秒，未收到时为 -1
+    unsigned long long max_nodes; // 每步的节点预算（扩展的 INFO max_nodes，0 为不限）
+    int ponder;                   // 扩展的 INFO ponder 1：对方思考时在后台搜索，预热置换表
+    int pondering;
+} ProtocolState;
+
+// 输出一行回复并立即刷新，管理程序按行读取
+static void reply(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+static void reply(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+    putchar('\n');
+    fflush(stdout);
+}
+
+// 本步的时间预算（秒）
+static double turnBudget(const ProtocolState *ps) {
+    long long ms = ps->timeout_turn;
+    if (ps->timeout_match > 0 && ps->time_left >= 0) {
+        long long share = ps->time_left / PROTOCOL_MOVES_TO_GO;
+        if (ms <= 0 || share < ms) ms = share;
+    }
+    ms -= PROTOCOL_TIME_MARGIN_MS;
+    if (ms < 1) ms = 1;
+    return ms / 1000.0;
+}
+
+// 每完成一次迭代输出一行 MESSAGE，管理程序会显示出来
+static void reportInfo(const SearchInfo *info, void *user) {
+    char pv[MAX_DEPTH * 8] = "";
+    size_t len = 0;
+    (void)user;
+    for (int i = 0; i < info->pv_length && len < sizeof(pv) - 8; i++) {
+        len += snprintf(pv + len, sizeof(pv) - len, " %d,%d", info->pv[i].col, info->pv[i].row);
+    }
+    reply("MESSAGE depth %d score %d nodes %llu nps %.0f hashfull %d pv%s", info->depth, info->score, info->nodes,
+          info->nps, info->hashfull, pv);
+}
+
+// 轮到对方时在后台搜索当前局面（不限深度与时间，不输出信息），只为填充置换表
+static void startPonder(ProtocolState *ps) {
+    if (!ps->ponder || checkWin(engine_game(ps->engine)) || isBoardFull(engine_game(ps->engine))) return;
+    SearchLimits limits = {SEARCH_DEPTH, 0, 0, 0, NULL, NULL, 0};
+    engine_set_info_callback(ps->engine, NULL, NULL);
+    ps->pondering = engine_start(ps->engine, &limits);
+}
+
+// 收到任何命令都先停下后台搜索，停止在 1024 个节点内生效
+static void stopPonder(ProtocolState *ps) {
+    if (!ps->pondering) return;
+    engine_stop(ps->engine);
+    engine_wait(ps->engine, NULL);
+    ps->pondering = 0;
+}
+
+// 为当前局面搜索并落子，回复 "x,y"
+static void playMove(ProtocolState *ps) {
+    // 给定节点预算时不再限时，便于复现对局
+    SearchLimits limits = {SEARCH_DEPTH, 0, ps->max_nodes, ps->max_nodes ? 0 : turnBudget(ps), NULL, NULL, 0};
+    SearchResult result;
+    engine_set_info_callback(ps->engine, reportInfo, NULL);
+    Position move = engine_search(ps->engine, &limits, &result);
+    if (move.row < 0 || engine_play(ps->engine, move.row, move.col) != VALID_MOVE) {
+        reply("ERROR no legal move");
+        return;
+    }
+    reply("MESSAGE depth %d score %d nodes %llu", result.depth, result.score, result.nodes);
+    reply("%d,%d", move.col, move.row);
+    startPonder(ps);
+}
+
+static int parseXY(const char *s, int *row, int *col) {
+    int x, y;
+    if (sscanf(s, " %d , %d", &x, &y) != 2) return 0;
+    if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE) return 0;
+    *row = y;
+    *col = x;
+    return 1;
+}
+
+// BOARD ... DONE：按给出的顺序摆子，1 为己方，2 为对方，结束后轮到己方
+static void readBoard(ProtocolState *ps) {
+    char line[256];
+    int rows[BOARD_SIZE * BOARD_SIZE], cols[BOARD_SIZE * BOARD_SIZE], owners[BOARD_SIZE * BOARD_SIZE];
+    int count = 0, own = 0, other = 0;
+    while (fgets(line, sizeof(line), stdin)) {
+        int x, y, field;
+        if (strncmp(line, "DONE", 4) == 0) break;
+        if (sscanf(line, " %d , %d , %d", &x, &y, &field) != 3) continue;
+        // 只有 1（己方）和 2（对方）是棋子，3（连续对局的标记）与其他取值跳过
+        if (field != 1 && field != 2) continue;
+        if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE || count >= BOARD_SIZE * BOARD_SIZE) continue;
+        rows[count] = y;
+        cols[count] = x;
+        owners[count] = field;
+        if (owners[count] == 1) own++;
+        else other++;
+        count++;
+    }
+
+    // 双方子数相等时己方是先手（黑），否则是后手（白）
+    Player me = (own == other) ? PLAYER_BLACK : PLAYER_WHITE;
+    Player opponent = (me == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK;
+    GameState game;
+    initGame(&game, MODE_PVE, ps->rule);
+    for (int i = 0; i < count; i++) {
+        if (getCell(&game, rows[i], cols[i]) != EMPTY) continue;
+        game.currentPlayer = (owners[i] == 1) ? me : opponent;
+        makeMoveTrusted(&game, rows[i], cols[i]);
+    }
+    game.currentPlayer = me;
+    if (ps->rule == RULE_STANDARD) {
+        forbiddenMapResolve(&game.forbidden, &game.bitBoard, board256Full());
+    }
+    engine_set_game(ps->engine, &game);
+    playMove(ps);
+}
+
+static void handleInfo(ProtocolState *ps, const char *args) {
+    char key[64];
+    long long value;
+    if (sscanf(args, "%63s %lld", key, &value) != 2) return;
+    if (strcmp(key, "timeout_turn") == 0) {
+        ps->timeout_turn = value;
+    } else if (strcmp(key, "timeout_match") == 0) {
+        ps->timeout_match = value;
+    } else if (strcmp(key, "time_left") == 0) {
+        ps->time_left = value;
+    } else if (strcmp(key, "ponder") == 0) {
+        ps->ponder = value != 0;
+    } else if (strcmp(key, "max_nodes") == 0) {
+        ps->max_nodes = (value > 0) ? (unsigned long long)value : 0;
+    } else if (strcmp(key, "max_memory") == 0) {
+        int tt_mb = (value > 0) ? (int)(value / PROTOCOL_TT_SHARE / (1024 * 1024)) : PROTOCOL_DEFAULT_TT_MB;
+        if (tt_mb > PROTOCOL_DEFAULT_TT_MB) tt_mb = PROTOCOL_DEFAULT_TT_MB;
+        // 大小不变时保留置换表内容
+        if (!engine_resize_tt(ps->engine, tt_mb)) reply("ERROR cannot allocate the transposition table");
+    } else if (strcmp(key, "rule") == 0) {
+        ps->rule = (value & PROTOCOL_GOMOCUP_RULE_RENJU) ? RULE_STANDARD : RULE_NO_FORBIDDEN;
+        // 开局前收到时立即生效
+        if (engine_game(ps->engine)->moveCount == 0) engine_set_position(ps->engine, ps->rule, NULL, 0);
+    }
+}
+
+int runGomocupProtocol(RuleType rule) {
+    ProtocolState ps;
+    char line[256];
+    memset(&ps, 0, sizeof(ps));
+    ps.rule = rule;
+    ps.timeout_turn = PROTOCOL_DEFAULT_TURN_MS;
+    ps.time_left = -1;
+    EngineConfig config;
+    engine_default_config(&config);
+    config.tt_mb = PROTOCOL_DEFAULT_TT_MB;
+    ps.engine = engine_new(&config);
+    if (!ps.engine) {
+        reply("ERROR cannot allocate the transposition table");
+        return 0;
+    }
+    engine_set_position(ps.engine, ps.rule, NULL, 0);
+
+    while (fgets(line, sizeof(line), stdin)) {
+        char cmd[32] = {0};
+        int row, col, n;
+        line[strcspn(line, "\r\n")] = 0;
+        if (sscanf(line, "%31s%n", cmd, &n) != 1) continue;
+        const char *args = line + n;
+        while (isspace((unsigned char)*args)) args++;
+        for (char *p = cmd; *p; p++) *p = toupper((unsigned char)*p);
+        stopPonder(&ps);
+
+        if (strcmp(cmd, "START") == 0) {
+            if (atoi(args) != BOARD_SIZE) {
+                reply("ERROR only %dx%d boards are supported", BOARD_SIZE, BOARD_SIZE);
+                continue;
+            }
+            engine_set_position(ps.engine, ps.rule, NULL, 0);
+            engine_clear(ps.engine);
+            reply("OK");
+        } else if (strcmp(cmd, "RESTART") == 0) {
+            engine_set_position(ps.engine, ps.rule, NULL, 0);
+            engine_clear(ps.engine);
+            reply("OK");
+        } else if (strcmp(cmd, "BEGIN") == 0) {
+            playMove(&ps);
+        } else if (strcmp(cmd, "TURN") == 0) {
+            if (!parseXY(args, &row, &col) || engine_play(ps.engine, row, col) != VALID_MOVE) {
+                reply("ERROR invalid move %s", args);
+                continue;
+            }
+            playMove(&ps);
+        } else if (strcmp(cmd, "BOARD") == 0) {
+            readBoard(&ps);
+        } else if (strcmp(cmd, "TAKEBACK") == 0) {
+            const GameState *game = engine_game(ps.engine);
+            if (!parseXY(args, &row, &col) || game->moveCount == 0 ||
+                game->lastMove.row != row || game->lastMove.col != col || !engine_undo(ps.engine)) {
+                reply("ERROR cannot take back %s", args);
+                continue;
+            }
+            reply("OK");
+        } else if (strcmp(cmd, "INFO") == 0) {
+            handleInfo(&ps, args);
+        } else if (strcmp(cmd, "ABOUT") == 0) {
+            reply("name=\"Gomoku_Remote\", version=\"1.0\", author=\"Ben-Daming\", country=\"CN\"");
+        } else if (strcmp(cmd, "END") == 0) {
+            break;
+        } else {
+            reply("UNKNOWN %s", cmd);
+        }
+    }
+    engine_free(ps.engine);
+    return 1;
+}
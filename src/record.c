@@ -25,8 +25,9 @@ static void fprint_board(const GameState *game, FILE *fp) {
     for (int i = 0; i < BOARD_SIZE; i++) {
         fprintf(fp, "%2d ", BOARD_SIZE - i);
         for (int j = 0; j < BOARD_SIZE; j++) {
-            if (game->board[i][j] == BLACK) fprintf(fp, "X ");
-            else if (game->board[i][j] == WHITE) fprintf(fp, "O ");
+            CellState cell = getCell(game, i, j);
+            if (cell == BLACK) fprintf(fp, "X ");
+            else if (cell == WHITE) fprintf(fp, "O ");
             else fprintf(fp, "+ ");
         }
         fprintf(fp, "%2d\n", BOARD_SIZE - i);
@@ -37,6 +38,42 @@ static void fprint_board(const GameState *game, FILE *fp) {
     fprintf(fp, "\n");
 }
 
+int recordWrite(const GameState *game, FILE *fp, const char *name) {
+    // Header
+    fprintf(fp, "file name: %s\n", name);
+    if (game->ruleType == RULE_STANDARD)
+        fprintf(fp, "ruletype: Standard\n");
+    else if(game->ruleType == RULE_NO_FORBIDDEN)
+        fprintf(fp, "ruletype: NaN\n");
+    if (game->mode == MODE_PVP)
+        fprintf(fp, "gamemode: PVP\n");
+    else
+        fprintf(fp, "gamemode: PVE\n");
+
+    fprintf(fp, "round: %-3d          winner: unknown\n", game->moveCount);
+    fprintf(fp, "\n");
+
+    // 按走子历史顺序输出
+    int count = game->history.count;
+    for (int i = 0; i < count; i++) {
+        int step = i + 1;
+        const HistoryEntry *e = &game->history.moves[i];
+        fprintf(fp, (count < 100) ? "%sstep %2d: %c%-2d%s" : "%sstep %3d: %c%-2d%s",
+                (step % 2) ? "" : "\t\t",
+                step,
+                'A' + e->col,
+                BOARD_SIZE - e->row,
+                (step % 2) ? "" : "\n");
+    }
+    
+    if (count % 2)
+        fprintf(fp, "\n");
+        
+    fprintf(fp, "\nfinal chessboard:\n");
+    fprint_board(game, fp);
+    return !ferror(fp);
+}
+
 int record(GameState* game) {
     char curtime[30];
     char file_name[100];
@@ -66,123 +103,70 @@ int record(GameState* game) {
         return 0;
     }
 
-    // Header
-    fprintf(fp, "file name: %s\n", curtime);
-    if (game->ruleType == RULE_STANDARD)
-        fprintf(fp, "ruletype: Standard\n");
-    else if(game->ruleType == RULE_NO_FORBIDDEN)
-        fprintf(fp, "ruletype: NaN\n");
-    if (game->mode == MODE_PVP)
-        fprintf(fp, "gamemode: PVP\n");
-    else
-        fprintf(fp, "gamemode: PVE\n");
-
-    fprintf(fp, "round: %-3d          winner: unknown\n", game->moveCount);
-    fprintf(fp, "\n");
-
-    // Collect moves from history
-    // Max moves = 225.
-    Position moves[BOARD_SIZE * BOARD_SIZE];
-    int count = 0;
-    
-    if (game->moveCount > 0) {
-        moves[count++] = game->lastMove;
-        HistoryNode* curr = game->historyHead;
-        while (curr) {
-            if (curr->moveCount > 0) {
-                moves[count++] = curr->lastMove;
-            }
-            curr = curr->next;
-        }
-    }
-    
-    // Print in reverse order (from count-1 down to 0)
-    if (count < 100) {
-        for (int i = count - 1; i >= 0; i--) {
-            int step = count - i;
-            Position p = moves[i];
-            fprintf(fp, "%sstep %2d: %c%-2d%s",
-                    (step % 2) ? "" : "\t\t",
-                    step,
-                    'A' + p.col,
-                    BOARD_SIZE - p.row,
-                    (step % 2) ? "" : "\n");
-        }
-    } else {
-        for (int i = count - 1; i >= 0; i--) {
-            int step = count - i;
-            Position p = moves[i];
-            fprintf(fp, "%sstep %3d: %c%-2d%s",
-                    (step % 2) ? "" : "\t\t",
-                    step,
-                    'A' + p.col,
-                    BOARD_SIZE - p.row,
-                    (step % 2) ? "" : "\n");
-        }
-    }
-    
-    if (count % 2)
-        fprintf(fp, "\n");
-        
-    fprintf(fp, "\nfinal chessboard:\n");
-    fprint_board(game, fp);
+    recordWrite(game, fp, curtime);
 
     fclose(fp);
     printf("Game recorded to %s\n", file_name);
     return 1;
 }
 
-int load(GameState* game, char* filename) {
-    FILE *fp = fopen(filename, "r");
-    if (!fp) {
-        printf("Could not open file %s\n", filename);
-        return 0;
-    }
-    
+int recordReadGame(FILE *fp, GameMode *mode, RuleType *rule, Position *moves, int *count) {
     char line[512];
-    GameMode mode = MODE_PVE; 
-    RuleType rule = RULE_STANDARD;
-    // Parse header for gamemode
+    int found = 0;
+    *count = 0;
+    // 单遍逐行读取：文件头决定模式与规则，"step N: XY" 给出走法，"final chessboard:" 结束一局
     while (fgets(line, sizeof(line), fp)) {
-        if (strstr(line, "gamemode: PVP")) {
-            mode = MODE_PVP;
+        if (strstr(line, "file name:")) {
+            found = 1;
+        } else if (strstr(line, "gamemode: PVP")) {
+            *mode = MODE_PVP;
         } else if (strstr(line, "gamemode: PVE")) {
-            mode = MODE_PVE;
+            *mode = MODE_PVE;
         } else if (strstr(line, "ruletype: Standard")){
-            rule = RULE_STANDARD;
+            *rule = RULE_STANDARD;
         } else if (strstr(line, "ruletype: NaN")){
-            rule = RULE_NO_FORBIDDEN;
+            *rule = RULE_NO_FORBIDDEN;
+        } else if (strstr(line, "final chessboard:")) {
+            return 1;
         }
-        if (strstr(line, "step 1:")) break; 
-    }
-    
-    initGame(game, mode, rule); 
-    
-    rewind(fp);
-    char word[100];
-    while (fscanf(fp, "%s", word) == 1) {
-        if (strcmp(word, "step") == 0) {
+
+        // 一行最多两步
+        for (char *p = strstr(line, "step"); p; p = strstr(p + 4, "step")) {
             int stepNum;
             char moveStr[10];
-            
-            if (fscanf(fp, "%d:", &stepNum) != 1) {
-                continue; 
-            }
-            
-            if (fscanf(fp, "%s", moveStr) == 1) {
-                char colChar = moveStr[0];
-                int rowVal = atoi(moveStr + 1);
-                
-                int col = colChar - 'A';
-                int row = BOARD_SIZE - rowVal;
-                
-                if (col >= 0 && col < BOARD_SIZE && row >= 0 && row < BOARD_SIZE) {
-                    makeMove(game, row, col);
-                }
+            if (sscanf(p, "step %d: %9s", &stepNum, moveStr) != 2) continue;
+
+            int col = moveStr[0] - 'A';
+            int row = BOARD_SIZE - atoi(moveStr + 1);
+            if (col >= 0 && col < BOARD_SIZE && row >= 0 && row < BOARD_SIZE &&
+                *count < BOARD_SIZE * BOARD_SIZE) {
+                moves[*count].row = row;
+                moves[*count].col = col;
+                (*count)++;
             }
+            found = 1;
         }
     }
+    return found;
+}
+
+int load(GameState* game, char* filename) {
+    FILE *fp = fopen(filename, "r");
+    if (!fp) {
+        printf("Could not open file %s\n", filename);
+        return 0;
+    }
     
+    GameMode mode = MODE_PVE; 
+    RuleType rule = RULE_STANDARD;
+    Position moves[BOARD_SIZE * BOARD_SIZE];
+    int count;
+    recordReadGame(fp, &mode, &rule, moves, &count);
     fclose(fp);
+
+    initGame(game, mode, rule); 
+    for (int i = 0; i < count; i++) {
+        makeMove(game, moves[i].row, moves[i].col);
+    }
     return 1;
 }
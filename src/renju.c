@@ -0,0 +1,320 @@
+#include "../include/renju.h"
+#include "../include/rules.h"
+#include "../include/bitboard.h"
+#include <string.h>
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define ABS(x) ((x) < 0 ? -(x) : (x))
+
+#define WINDOW_FOUR 0x1F  // 冲四窗口（5格）
+#define WINDOW_THREE 0x3F // 活三窗口（6格）
+
+// 禁手检测用的工作副本，只需要4个方向的线
+typedef struct {
+    LinePair cols[BOARD_SIZE];
+    LinePair rows[BOARD_SIZE];
+    LinePair diag1[BOARD_SIZE * 2];
+    LinePair diag2[BOARD_SIZE * 2];
+    int complex; // 是否检查过关键点的长连或递归判断过活三
+} RenjuBoard;
+
+// 过某点的一条线
+typedef struct {
+    unsigned int black, white;
+    int len;        // 线长
+    int pos;        // 该点在线上的位
+    int r0, c0;     // 第0位的坐标
+    int dr, dc;     // 第 i 位的坐标为 (r0 + dr * i, c0 + dc * i)
+} RenjuLine;
+
+// 方向：0 水平，1 垂直，2 对角线 \，3 对角线 /
+static void getLine(const RenjuBoard *rb, int row, int col, int dir, RenjuLine *ln) {
+    const LinePair *pair;
+    switch (dir) {
+        case 0:
+            pair = &rb->rows[row];
+            ln->len = BOARD_SIZE;
+            ln->pos = col;
+            ln->r0 = row; ln->c0 = 0; ln->dr = 0; ln->dc = 1;
+            break;
+        case 1:
+            pair = &rb->cols[col];
+            ln->len = BOARD_SIZE;
+            ln->pos = row;
+            ln->r0 = 0; ln->c0 = col; ln->dr = 1; ln->dc = 0;
+            break;
+        case 2: {
+            int k = row - col + 14;
+            pair = &rb->diag1[k];
+            ln->len = BOARD_SIZE - ABS(k - 14);
+            ln->pos = MIN(row, col);
+            ln->r0 = MAX(0, k - 14); ln->c0 = MAX(0, 14 - k); ln->dr = 1; ln->dc = 1;
+            break;
+        }
+        default: {
+            int s = row + col;
+            pair = &rb->diag2[s];
+            ln->len = BOARD_SIZE - ABS(s - 14);
+            ln->pos = MIN(row, 14 - col);
+            ln->r0 = MAX(0, s - 14); ln->c0 = s - ln->r0; ln->dr = 1; ln->dc = -1;
+            break;
+        }
+    }
+    ln->black = pair->black;
+    ln->white = pair->white;
+}
+
+static void placeBlack(RenjuBoard *rb, int row, int col) {
+    rb->cols[col].black |= 1 << row;
+    rb->rows[row].black |= 1 << col;
+    rb->diag1[row - col + 14].black |= 1 << MIN(row, col);
+    rb->diag2[row + col].black |= 1 << MIN(row, 14 - col);
+    rb->cols[col].white &= ~(1 << row);
+    rb->rows[row].white &= ~(1 << col);
+    rb->diag1[row - col + 14].white &= ~(1 << MIN(row, col));
+    rb->diag2[row + col].white &= ~(1 << MIN(row, 14 - col));
+}
+
+static void removeBlack(RenjuBoard *rb, int row, int col) {
+    rb->cols[col].black &= ~(1 << row);
+    rb->rows[row].black &= ~(1 << col);
+    rb->diag1[row - col + 14].black &= ~(1 << MIN(row, col));
+    rb->diag2[row + col].black &= ~(1 << MIN(row, 14 - col));
+}
+
+// 从 pos 起（含）向高位的连续黑子数
+static inline int runForward(unsigned int black, int pos) {
+    return __builtin_ctz(~(black >> pos));
+}
+
+// 从 pos - 1 起向低位的连续黑子数
+static inline int runBackward(unsigned int black, int pos) {
+    if (pos == 0) return 0;
+    return __builtin_clz(~(black << (32 - pos)));
+}
+
+// 假设在 (row, col) 落一颗黑子，是否形成长连
+static int overlineIfPlaced(const RenjuBoard *rb, int row, int col) {
+    for (int d = 0; d < 4; d++) {
+        RenjuLine ln;
+        getLine(rb, row, col, d, &ln);
+        unsigned int black = ln.black | (1u << ln.pos);
+        if (runForward(black, ln.pos) + runBackward(black, ln.pos) > 5) return 1;
+    }
+    return 0;
+}
+
+// 以下三个棋型函数的 verify 为0时只做棋型匹配，跳过关键点的长连检查与递归禁手检查，
+// 得到的数目不小于精确值，用来在不可能凑够2个时提前排除
+
+// 连起来的四：恰好4连，且至少一端的空位落子后不成长连
+static int huoFour(const RenjuBoard *rb, const RenjuLine *ln, int verify) {
+    int fwd = runForward(ln->black, ln->pos);
+    int bwd = runBackward(ln->black, ln->pos);
+    if (fwd + bwd != 4) return 0;
+
+    int end = ln->pos + fwd;
+    if (end < ln->len && !((ln->white >> end) & 1) &&
+        (!verify || !overlineIfPlaced(rb, ln->r0 + ln->dr * end, ln->c0 + ln->dc * end))) return 1;
+    end = ln->pos - bwd - 1;
+    if (end >= 0 && !((ln->white >> end) & 1) &&
+        (!verify || !overlineIfPlaced(rb, ln->r0 + ln->dr * end, ln->c0 + ln->dc * end))) return 1;
+    return 0;
+}
+
+// 跳冲四：包含该点的每个5格窗口按 PATTERN_CHONG_FOUR_* 匹配，关键点落子不成长连才计数
+static int chongFour(const RenjuBoard *rb, const RenjuLine *ln, int verify) {
+    int num = 0;
+    for (int s = ln->pos; s >= 0 && s > ln->pos - 5; s--) {
+        if (s + 5 > ln->len || ((ln->white >> s) & WINDOW_FOUR)) continue;
+
+        int key;
+        switch ((ln->black >> s) & WINDOW_FOUR) {
+            case PATTERN_CHONG_FOUR_1: key = s + 2; break;
+            case PATTERN_CHONG_FOUR_2: key = s + 1; break;
+            case PATTERN_CHONG_FOUR_3: key = s + 3; break;
+            default: continue;
+        }
+        if (!verify || !overlineIfPlaced(rb, ln->r0 + ln->dr * key, ln->c0 + ln->dc * key)) num++;
+    }
+    return num;
+}
+
+static int forbiddenAt(RenjuBoard *rb, int row, int col);
+
+// 活三：6格窗口按 PATTERN_HUO_THREE_* 匹配，两侧不能紧贴黑子，且关键点本身不是禁手
+static int huoThree(RenjuBoard *rb, const RenjuLine *ln, int verify) {
+    for (int s = ln->pos - 1; s >= 0 && s >= ln->pos - 4; s--) {
+        if (s > 0 && ((ln->black >> (s - 1)) & 1)) continue;
+        if (s + 6 > ln->len || ((ln->white >> s) & WINDOW_THREE)) continue;
+        if (s + 6 < ln->len && ((ln->black >> (s + 6)) & 1)) continue;
+
+        int key;
+        switch ((ln->black >> s) & WINDOW_THREE) {
+            case PATTERN_HUO_THREE_1: key = s + 4; break;
+            case PATTERN_HUO_THREE_2: key = s + 1; break;
+            case PATTERN_HUO_THREE_3: key = s + 2; break;
+            case PATTERN_HUO_THREE_4: key = s + 3; break;
+            default: continue;
+        }
+        if (!verify || !forbiddenAt(rb, ln->r0 + ln->dr * key, ln->c0 + ln->dc * key)) return 1;
+    }
+    return 0;
+}
+
+// 在副本上落子判断，返回前撤销
+static int forbiddenAt(RenjuBoard *rb, int row, int col) {
+    RenjuLine lines[4];
+    int forbidden = 0;
+
+    placeBlack(rb, row, col);
+    for (int d = 0; d < 4; d++) getLine(rb, row, col, d, &lines[d]);
+
+    // 1. 长连
+    for (int d = 0; d < 4 && !forbidden; d++) {
+        if (runForward(lines[d].black, lines[d].pos) + runBackward(lines[d].black, lines[d].pos) > 5) {
+            forbidden = ERR_FORBIDDEN_OVERLINE;
+        }
+    }
+
+    if (!forbidden) {
+        // 2. 四四：只匹配棋型已不足2个时不必检查关键点
+        int num_four = 0;
+        for (int d = 0; d < 4; d++) {
+            num_four += huoFour(rb, &lines[d], 0) + chongFour(rb, &lines[d], 0);
+        }
+        if (num_four >= 2) {
+            rb->complex = 1;
+            num_four = 0;
+            for (int d = 0; d < 4; d++) {
+                num_four += huoFour(rb, &lines[d], 1) + chongFour(rb, &lines[d], 1);
+            }
+        }
+        if (num_four >= 2) {
+            forbidden = ERR_FORBIDDEN_44;
+        } else {
+            // 3. 三三（递归会临时改动 rb，但返回前都已恢复，lines 仍然有效）
+            // 先找出有活三棋型的方向，不足2个时不必递归
+            int candidate[4], num_candidates = 0;
+            for (int d = 0; d < 4; d++) {
+                candidate[d] = huoThree(rb, &lines[d], 0);
+                num_candidates += candidate[d];
+            }
+            int num_three = 0;
+            int remaining = (num_candidates >= 2) ? num_candidates : 0;
+            if (remaining) rb->complex = 1;
+            for (int d = 0; d < 4 && remaining > 0 && num_three < 2 && num_three + remaining >= 2; d++) {
+                if (!candidate[d]) continue;
+                remaining--;
+                num_three += huoThree(rb, &lines[d], 1);
+            }
+            if (num_three >= 2) forbidden = ERR_FORBIDDEN_33;
+        }
+    }
+
+    removeBlack(rb, row, col);
+    return forbidden;
+}
+
+int renjuForbidden(const BitBoardState *board, int row, int col) {
+    RenjuBoard rb;
+    memcpy(rb.cols, board->cols, sizeof(rb.cols));
+    memcpy(rb.rows, board->rows, sizeof(rb.rows));
+    memcpy(rb.diag1, board->diag1, sizeof(rb.diag1));
+    memcpy(rb.diag2, board->diag2, sizeof(rb.diag2));
+    rb.complex = 0;
+    return forbiddenAt(&rb, row, col);
+}
+
+int renjuForbiddenDetail(const BitBoardState *board, int row, int col, int *complex) {
+    *complex = 0;
+    if (!renjuMayBeForbidden(board, row, col)) return 0;
+
+    RenjuBoard rb;
+    memcpy(rb.cols, board->cols, sizeof(rb.cols));
+    memcpy(rb.rows, board->rows, sizeof(rb.rows));
+    memcpy(rb.diag1, board->diag1, sizeof(rb.diag1));
+    memcpy(rb.diag2, board->diag2, sizeof(rb.diag2));
+    rb.complex = 0;
+    int verdict = forbiddenAt(&rb, row, col);
+    *complex = rb.complex;
+    return verdict;
+}
+
+// --- 增量禁手位图 ---
+
+// 每个点4条线上前后5格（含自身）的掩码：这些点的非 complex 判定会受该点影响
+static Board256 touch_masks[BOARD_SIZE][BOARD_SIZE];
+static int touch_masks_ready = 0;
+
+static void initTouchMasks(void) {
+    static const int dr[4] = {0, 1, 1, 1};
+    static const int dc[4] = {1, 0, 1, -1};
+    for (int r = 0; r < BOARD_SIZE; r++) {
+        for (int c = 0; c < BOARD_SIZE; c++) {
+            Board256 mask = board256Zero();
+            for (int d = 0; d < 4; d++) {
+                for (int k = -5; k <= 5; k++) {
+                    int nr = r + dr[d] * k, nc = c + dc[d] * k;
+                    if (nr >= 0 && nr < BOARD_SIZE && nc >= 0 && nc < BOARD_SIZE) board256Set(&mask, nr, nc);
+                }
+            }
+            touch_masks[r][c] = mask;
+        }
+    }
+    touch_masks_ready = 1;
+}
+
+void forbiddenMapInit(ForbiddenMap *map) {
+    if (!touch_masks_ready) initTouchMasks();
+    map->forbidden = board256Zero();
+    map->dirty = board256Full();
+    map->complex = board256Zero();
+}
+
+void forbiddenMapTouch(ForbiddenMap *map, int row, int col) {
+    map->dirty = board256Or(map->dirty, touch_masks[row][col]);
+}
+
+// 重新判断一个空位
+static void resolveCell(ForbiddenMap *map, const BitBoardState *board, int row, int col) {
+    int complex;
+    if (renjuForbiddenDetail(board, row, col, &complex)) board256Set(&map->forbidden, row, col);
+    if (complex) board256Set(&map->complex, row, col);
+}
+
+void forbiddenMapResolve(ForbiddenMap *map, const BitBoardState *board, Board256 cells) {
+    Board256 todo = board256And(cells, board256Or(map->dirty, map->complex));
+    if (board256IsEmpty(todo)) return;
+
+    map->dirty = board256AndNot(map->dirty, todo);
+    map->forbidden = board256AndNot(map->forbidden, todo);
+    map->complex = board256AndNot(map->complex, todo);
+
+    // 已落子的点只需清除标记
+    todo = board256AndNot(todo, occupiedBoard256(board));
+    int row, col;
+    while (board256PopFirst(&todo, &row, &col)) {
+        resolveCell(map, board, row, col);
+    }
+}
+
+int forbiddenMapTest(ForbiddenMap *map, const BitBoardState *board, int row, int col) {
+    if (board256Test(&map->dirty, row, col) || board256Test(&map->complex, row, col)) {
+        board256Reset(&map->dirty, row, col);
+        board256Reset(&map->forbidden, row, col);
+        board256Reset(&map->complex, row, col);
+        resolveCell(map, board, row, col);
+    }
+    return board256Test(&map->forbidden, row, col);
+}
+
+int renjuGenerateMoves(const BitBoardState *board, ForbiddenMap *map, Player player, Position *moves) {
+    Board256 candidates = candidateBoard256(board);
+    if (map && player == PLAYER_BLACK) {
+        forbiddenMapResolve(map, board, candidates);
+        candidates = board256AndNot(candidates, map->forbidden);
+    }
+    return board256ToMoves(candidates, moves);
+}
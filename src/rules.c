@@ -1,4 +1,6 @@
 #include "../include/rules.h"
+#include "../include/board.h"
+#include "../include/renju.h"
 #include <stdio.h>
 
 // 方向：水平，垂直，对角线 \, 对角线 /
@@ -17,14 +19,14 @@ static int countLine(const GameState *game, int r, int c, int dirIdx, Player p)
     for (int i = 1; i < 6; i++) {
         int nr = r + dr[dirIdx] * i;
         int nc = c + dc[dirIdx] * i;
-        if (isValidPos(nr, nc) && game->board[nr][nc] == (CellState)p) count++;
+        if (isValidPos(nr, nc) && getCell(game, nr, nc) == (CellState)p) count++;
         else break;
     }
     // 反向统计
     for (int i = 1; i < 6; i++) {
         int nr = r - dr[dirIdx] * i;
         int nc = c - dc[dirIdx] * i;
-        if (isValidPos(nr, nc) && game->board[nr][nc] == (CellState)p) count++;
+        if (isValidPos(nr, nc) && getCell(game, nr, nc) == (CellState)p) count++;
         else break;
     }
     return count;
@@ -36,7 +38,7 @@ int checkWin(const GameState *game) {
     
     int r = game->lastMove.row;
     int c = game->lastMove.col;
-    CellState cell = game->board[r][c];
+    CellState cell = getCell(game, r, c);
     if (cell == EMPTY) return 0;
     Player p = (cell == BLACK) ? PLAYER_BLACK : PLAYER_WHITE;
 
@@ -61,227 +63,16 @@ int checkWin(const GameState *game) {
 
 
 
-// TODO: 实现完整的三三和四四禁手检测。
-
-// 递归，提前声明
-int isForbidden(const GameState *game, int row, int col);
-// 长连检测，提前声明
-static int isOverline(const GameState *game, int r, int c);
-
-// 辅助函数：检查在 (r, c) 落子是否会导致长连（用于判断端点是否被堵死）
-static int checkPotentialOverline(GameState *game, int r, int c) {
-    if (!isValidPos(r, c)) return 0;
-    // 只有空位才需要模拟，如果是白子自然是堵死的（调用者已处理），如果是黑子则连成一体
-    if (game->board[r][c] != EMPTY) return 0;
-    
-    game->board[r][c] = BLACK;
-    int result = isOverline(game, r, c);
-    game->board[r][c] = EMPTY;
-    return result;
-}
-
-// 判断是否为连起来的有效四
-static int isHuoFour(const GameState *game, int i, int j, int dx, int dy) {
-    int num;
-    int now_i, now_j;
-    int l_edge = 1;
-    int r_edge = 1;
-    GameState *mutableGame = (GameState *)game;
-
-    // 正向算连珠数目
-    for (now_i = i, now_j = j, num = 0; 
-         isValidPos(now_i, now_j) && game->board[now_i][now_j] == BLACK; 
-         now_i += dx, now_j += dy, num++);    
-
-    if (!isValidPos(now_i, now_j) || game->board[now_i][now_j] == WHITE) {
-        l_edge = 0; 
-    } else {
-        // 检查该端点落子是否会导致长连
-        if (checkPotentialOverline(mutableGame, now_i, now_j)) l_edge = 0;
-    }
-
-    // 反向算连珠数目
-    for (now_i = i - dx, now_j = j - dy; 
-         isValidPos(now_i, now_j) && game->board[now_i][now_j] == BLACK; 
-         now_i -= dx, now_j -= dy, num++);    
-
-    if (!isValidPos(now_i, now_j) || game->board[now_i][now_j] == WHITE) {
-        r_edge = 0; 
-    } else {
-        // 检查该端点落子是否会导致长连
-        if (checkPotentialOverline(mutableGame, now_i, now_j)) r_edge = 0;
-    }
-
-    if (num != 4 || (!l_edge && !r_edge)) 
-        return 0;
-
-    if ((r_edge) || (l_edge)) 
-        return 1;
-    else 
-        return 0;
-}
-
-// 判断是否为跳跃型的三种冲四
-static int isChongFour(const GameState *game, int i, int j, int dx, int dy) {
-    int value, key_i, key_j, now_i, now_j, search_i, search_j;
-    int num = 0;
-    int index1, index2;
-    index2 = 0;
-    GameState *mutableGame = (GameState *)game;
-
-    for (now_i = i, now_j = j; index2 < 5 && isValidPos(now_i, now_j); 
-         now_i -= dx, now_j -= dy, index2++) { 
-        value = 0;
-        search_i = now_i;
-        search_j = now_j;
-        for (index1 = 0; index1 < 5 && isValidPos(search_i, search_j); 
-             index1++, search_i += dx, search_j += dy) {
-            if (game->board[search_i][search_j] == WHITE) 
-                break;
-            else if (game->board[search_i][search_j] == BLACK)
-                value |= (1 << index1);
-            // 空位不操作
-        } 
-        if (index1 == 5) {
-            key_i = -1; // Init invalid
-            if (value == PATTERN_CHONG_FOUR_1) {
-                key_i = now_i + 2*dx;
-                key_j = now_j + 2*dy;
-            } else if (value == PATTERN_CHONG_FOUR_2) {
-                key_i = now_i + 1*dx;
-                key_j = now_j + 1*dy;
-            } else if (value == PATTERN_CHONG_FOUR_3) {
-                key_i = now_i + 3*dx;
-                key_j = now_j + 3*dy;
-            }
-
-            if (key_i != -1) {
-                // 检查关键点落子是否会导致长连
-                if (!checkPotentialOverline(mutableGame, key_i, key_j)) {
-                    num++;
-                }
-            }
-        }
-    }
-    return num;
-}
-
-// 判断是否为活三
-static int isHuoThree(const GameState *game, int i, int j, int dx, int dy) {
-    int value, key_i, key_j, now_i, now_j, end_i, end_j, search_i, search_j;
-    int index1;     
-    int index2 = 0; 
-
-    for (now_i = i - dx, now_j = j - dy; index2 < 4 && isValidPos(now_i, now_j); 
-         now_i -= dx, now_j -= dy, index2++) {
-        value = 0;
-        search_i = now_i - dx;
-        search_j = now_j - dy;
-        // 检查左侧是否被黑子堵住（否则会变成长连）
-        if (isValidPos(search_i, search_j) && game->board[search_i][search_j] == BLACK) 
-            continue; 
-
-        search_i = now_i;
-        search_j = now_j;
-        for (index1 = 0; index1 < 6 && isValidPos(search_i, search_j); 
-             index1++, search_i += dx, search_j += dy) {
-            if (game->board[search_i][search_j] == WHITE) 
-                break;
-            else if (game->board[search_i][search_j] == BLACK)
-                value |= (1 << index1);
-            // 空位不操作
-        } 
-
-        end_i = now_i + index1*dx;
-        end_j = now_j + index1*dy;
-
-        if(index1 < 6) continue;
-        // 检查右侧是否被黑子堵住
-        else if(!isValidPos(end_i, end_j) || game->board[end_i][end_j] != BLACK) {
-            switch (value) {
-                case PATTERN_HUO_THREE_1:
-                    key_i = now_i + dx*4;  
-                    key_j = now_j + dy*4;  
-                    if (!isForbidden(game, key_i, key_j)) 
-                        return 1;  
-                    break;
-                case PATTERN_HUO_THREE_2:
-                    key_i = now_i + dx*1;  
-                    key_j = now_j + dy*1;  
-                    if (!isForbidden(game, key_i, key_j)) 
-                        return 1;
-                    break;
-                case PATTERN_HUO_THREE_3:
-                    key_i = now_i + dx*2;  
-                    key_j = now_j + dy*2;  
-                    if (!isForbidden(game, key_i, key_j)) 
-                        return 1;
-                    break;
-                case PATTERN_HUO_THREE_4:
-                    key_i = now_i + dx*3;  
-                    key_j = now_j + dy*3;  
-                    if (!isForbidden(game, key_i, key_j)) 
-                        return 1; 
-                    break;
-            }
-        } 
-    }
-    return 0;
-}
-
-// 判断是否为长连
-static int isOverline(const GameState *game, int r, int c) {
-    for (int i = 0; i < 4; i++) {
-        if (countLine(game, r, c, i, PLAYER_BLACK) > 5) return 1;
-    }
-    return 0;
-}
-
-// 禁手检测
+// 禁手检测（只有黑方有禁手），具体判定在 renju.c 中基于位棋盘完成
 int isForbidden(const GameState *game, int row, int col) {
     if (game->ruleType != RULE_STANDARD) return 0;
-    // 只有黑方有禁手
-    // isHuoThree 递归调用时是检测潜在落子是否为禁手。
-    // 但 isForbidden 只会用于黑方落子。
-
-    GameState *mutableGame = (GameState *)game;
-    CellState original = mutableGame->board[row][col];
-    mutableGame->board[row][col] = BLACK;
-
-    int forbidden = 0;
-
-    // 1. 长连
-    if (isOverline(mutableGame, row, col)) {
-        forbidden = ERR_FORBIDDEN_OVERLINE;
-    } else {
-        int num_four = 0;
-        int num_three = 0;
-
-        // 检查四个方向
-        for (int i = 0; i < 4; i++) {
-            if (isHuoFour(mutableGame, row, col, dr[i], dc[i])) num_four++;
-            num_four += isChongFour(mutableGame, row, col, dr[i], dc[i]);
-        }
-        
-        // 剪枝：如果已经是四四禁手，就不需要再算三三了
-        if (num_four >= 2) {
-            forbidden = ERR_FORBIDDEN_44;
-        } else {
-            for (int i = 0; i < 4; i++) {
-                num_three += isHuoThree(mutableGame, row, col, dr[i], dc[i]);
-            }
-            if (num_three >= 2) forbidden = ERR_FORBIDDEN_33;
-        }
-    }
-    
-    mutableGame->board[row][col] = original; // 恢复原状态
-    return forbidden;
+    return renjuForbidden(&game->bitBoard, row, col);
 }
 
 // 检查落子是否合法
 int checkValidMove(const GameState *game, int row, int col) {
     if (!isValidPos(row, col)) return ERR_OUT_OF_BOUNDS;
-    if (game->board[row][col] != EMPTY) return ERR_OCCUPIED;
+    if (getCell(game, row, col) != EMPTY) return ERR_OCCUPIED;
 
     if (game->currentPlayer == PLAYER_BLACK && game->ruleType == RULE_STANDARD) {
         int forbidden = isForbidden(game, row, col);
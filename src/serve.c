@@ -0,0 +1,1006 @@
+#include "../include/serve.h"
+#include "../include/engine.h"
+#include "../include/book.h"
+#include "../include/board.h"
+#include "../include/rules.h"
+#include "../include/renju.h"
+#include "../include/board256.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define SERVE_REQUEST_MAX 16384   // 单个请求（HTTP 头部加请求体，或一行）的最大长度
+#define SERVE_RESPONSE_MAX 4096
+#define SERVE_MAX_FIELDS 16
+#define SERVE_VALUE_MAX 1024
+#define SERVE_ID_MAX 72          // 编码后的 id 最多 SERVE_ID_MAX - 2 个字符（见 serve.h）
+#define SERVE_LATENCY_WINDOW 4096 // 统计尾延迟时保留的最近请求数
+
+typedef struct Job Job;
+typedef struct Client Client;
+
+// 一个连接。读线程负责解析请求，工作线程直接把回复写回连接
+struct Client {
+    int fd;
+    int http;
+    int keep_alive;       // HTTP: 回复后是否继续读下一个请求
+    pthread_mutex_t lock; // 保护写 fd 与 pending
+    pthread_cond_t idle;
+    int pending;          // 已排队或正在处理的请求数
+    Job *head, *tail;     // 排队中的请求（受 pool.lock 保护）
+    Client *next_ready;   // 有排队请求的连接组成的轮转队列
+    int ready;
+};
+
+struct Job {
+    Job *next;
+    Client *client;
+    char id[SERVE_ID_MAX]; // 已编码为 JSON 的 id，没有时为空串
+    GameState game;
+    SearchLimits limits;
+    int multipv;
+    int use_book;
+    int clear;      // 搜索前清空置换表，结果可以复现
+    int stream;     // 每完成一次迭代发送一行进度（只用于 Unix 套接字）
+    int line;       // 正在搜索的主变序号（从1开始）
+    atomic_int cancelled; // 已被 stop 或断开连接取消，不再搜索后面的主变
+    double submitted;
+};
+
+// 工作线程与它正在处理的请求（受 pool.lock 保护），停止请求时据此找到要停的引擎
+typedef struct {
+    Engine *engine;
+    Job *job;
+} Worker;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    Client *ready_head, *ready_tail;
+    int queued;
+    int workers;
+    Worker *worker_list;
+    // 统计
+    unsigned long long served, book_hits, rejected, failed;
+    double latency[SERVE_LATENCY_WINDOW]; // 毫秒，从收到请求到写出回复
+    int latency_count, latency_next;
+    double started;
+} Pool;
+
+typedef struct {
+    char key[32];
+    char value[SERVE_VALUE_MAX];
+    int is_string;
+} JsonField;
+
+typedef struct {
+    JsonField fields[SERVE_MAX_FIELDS];
+    int count;
+} JsonObject;
+
+typedef struct {
+    char *buf;
+    size_t size, len;
+} Output;
+
+static Pool pool;
+static const ServeOptions *serve_options;
+static OpeningBook book; // 启动时读入，之后只读
+static volatile sig_atomic_t serve_stop;
+
+void serveDefaults(ServeOptions *options) {
+    memset(options, 0, sizeof(*options));
+    options->workers = 0;
+    options->tt_mb = 16;
+    options->queue_limit = 1024;
+    options->max_depth = 8;
+    options->rule = RULE_STANDARD;
+    options->book_ply = BOOK_DEFAULT_PLY;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void emit(Output *o, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void emit(Output *o, const char *fmt, ...) {
+    va_list ap;
+    if (o->len >= o->size) return;
+    va_start(ap, fmt);
+    int n = vsnprintf(o->buf + o->len, o->size - o->len, fmt, ap);
+    va_end(ap);
+    if (n > 0) o->len += (size_t)n;
+    if (o->len >= o->size) o->len = o->size - 1;
+}
+
+static void emitString(Output *o, const char *s) {
+    emit(o, "\"");
+    for (; *s; s++) {
+        unsigned char ch = (unsigned char)*s;
+        if (ch == '"' || ch == '\\') emit(o, "\\%c", ch);
+        else if (ch < 0x20) emit(o, "\\u%04x", ch);
+        else emit(o, "%c", ch);
+    }
+    emit(o, "\"");
+}
+
+static void emitMove(Output *o, Position p) {
+    emit(o, "\"%c%d\"", 'A' + p.col, BOARD_SIZE - p.row);
+}
+
+// ---- JSON（只支持一层对象） ----
+
+static const char *skipSpace(const char *s) {
+    while (isspace((unsigned char)*s)) s++;
+    return s;
+}
+
+// 读一个字符串（s 指向左引号），写入 out，返回右引号之后的位置，出错返回 NULL
+static const char *parseString(const char *s, char *out, size_t size) {
+    size_t n = 0;
+    for (s++; *s && *s != '"'; s++) {
+        char ch = *s;
+        if (ch == '\\') {
+            s++;
+            switch (*s) {
+            case 'n': ch = '\n'; break;
+            case 't': ch = '\t'; break;
+            case 'r': ch = '\r'; break;
+            case 'b': ch = '\b'; break;
+            case 'f': ch = '\f'; break;
+            case 'u':
+                for (int i = 1; i <= 4; i++) {
+                    if (!isxdigit((unsigned char)s[i])) return NULL;
+                }
+                s += 4;
+                ch = '?'; // 非 ASCII 字符在请求里没有意义
+                break;
+            case '"': case '\\': case '/': ch = *s; break;
+            default: return NULL;
+            }
+        }
+        if (n + 1 >= size) return NULL;
+        out[n++] = ch;
+    }
+    if (*s != '"') return NULL;
+    out[n] = 0;
+    return s + 1;
+}
+
+static const char *parseJson(const char *s, JsonObject *obj) {
+    obj->count = 0;
+    s = skipSpace(s);
+    if (*s != '{') return "request must be a JSON object";
+    s = skipSpace(s + 1);
+    if (*s == '}') return skipSpace(s + 1)[0] ? "trailing characters after the object" : NULL;
+    for (;;) {
+        if (obj->count == SERVE_MAX_FIELDS) return "too many fields";
+        JsonField *f = &obj->fields[obj->count++];
+        if (*s != '"' || !(s = parseString(s, f->key, sizeof(f->key)))) return "bad field name";
+        s = skipSpace(s);
+        if (*s != ':') return "expected ':'";
+        s = skipSpace(s + 1);
+        if (*s == '"') {
+            f->is_string = 1;
+            if (!(s = parseString(s, f->value, sizeof(f->value)))) return "bad string value";
+        } else {
+            // 数字或 true/false/null
+            size_t n = 0;
+            f->is_string = 0;
+            while (*s && (isalnum((unsigned char)*s) || *s == '-' || *s == '+' || *s == '.')) {
+                if (n + 1 >= sizeof(f->value)) return "value too long";
+                f->value[n++] = *s++;
+            }
+            f->value[n] = 0;
+            if (n == 0) return "unsupported value (objects and arrays are not accepted)";
+        }
+        s = skipSpace(s);
+        if (*s == '}') break;
+        if (*s != ',') return "expected ',' or '}'";
+        s = skipSpace(s + 1);
+    }
+    return skipSpace(s + 1)[0] ? "trailing characters after the object" : NULL;
+}
+
+static const JsonField *jsonGet(const JsonObject *obj, const char *key) {
+    for (int i = 0; i < obj->count; i++) {
+        if (strcmp(obj->fields[i].key, key) == 0) return &obj->fields[i];
+    }
+    return NULL;
+}
+
+static int jsonNumber(const JsonField *f, double *value) {
+    char *end;
+    if (!f || f->is_string) return 0;
+    *value = strtod(f->value, &end);
+    return end != f->value && *end == 0;
+}
+
+// ---- 请求 ----
+
+// "H8 I9 G9" 或 "h8i9g9"
+static const char *parseMoves(const char *s, GameState *game) {
+    while (*s) {
+        if (isspace((unsigned char)*s) || *s == ',') {
+            s++;
+            continue;
+        }
+        int col = toupper((unsigned char)*s) - 'A';
+        char *end;
+        long rank = strtol(s + 1, &end, 10);
+        if (col < 0 || col >= BOARD_SIZE || end == s + 1 || rank < 1 || rank > BOARD_SIZE) return "bad move in \"moves\"";
+        if (makeMove(game, BOARD_SIZE - (int)rank, col) != VALID_MOVE) return "illegal move in \"moves\"";
+        if (checkWin(game)) return "the game is already over";
+        s = end;
+    }
+    return NULL;
+}
+
+// 225 个 '.' / 'x' / 'o'，按行从上到下，与 readBoard 一样直接摆子
+static const char *parseBoard(const char *s, const JsonField *side, GameState *game) {
+    int black = 0, white = 0, n = 0;
+    for (; *s; s++) {
+        char ch = tolower((unsigned char)*s);
+        if (isspace((unsigned char)ch)) continue;
+        if (n == BOARD_SIZE * BOARD_SIZE) return "\"board\" has more than 225 cells";
+        if (ch == 'x' || ch == 'o') {
+            game->currentPlayer = (ch == 'x') ? PLAYER_BLACK : PLAYER_WHITE;
+            makeMoveTrusted(game, n / BOARD_SIZE, n % BOARD_SIZE);
+            if (ch == 'x') black++;
+            else white++;
+        } else if (ch != '.') {
+            return "\"board\" cells must be '.', 'x' or 'o'";
+        }
+        n++;
+    }
+    if (n != BOARD_SIZE * BOARD_SIZE) return "\"board\" must have 225 cells";
+    // 与 "moves" 一样拒绝已经分出胜负的局面：checkWin 只看最后一步，这里逐个棋子当作最后一步检查
+    Position last = game->lastMove;
+    for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+        if (getCell(game, i / BOARD_SIZE, i % BOARD_SIZE) == EMPTY) continue;
+        game->lastMove = (Position){i / BOARD_SIZE, i % BOARD_SIZE};
+        if (checkWin(game)) return "the game is already over";
+    }
+    game->lastMove = last;
+    if (side && strcmp(side->value, "black") == 0) game->currentPlayer = PLAYER_BLACK;
+    else if (side && strcmp(side->value, "white") == 0) game->currentPlayer = PLAYER_WHITE;
+    else if (side) return "\"side\" must be \"black\" or \"white\"";
+    else game->currentPlayer = (black == white) ? PLAYER_BLACK : PLAYER_WHITE;
+    if (game->ruleType == RULE_STANDARD) {
+        forbiddenMapResolve(&game->forbidden, &game->bitBoard, board256Full());
+    }
+    return NULL;
+}
+
+static const char *buildJob(const JsonObject *req, Job *job) {
+    const JsonField *f;
+    double v;
+    RuleType rule = serve_options->rule;
+    if ((f = jsonGet(req, "rule"))) {
+        if (strcmp(f->value, "std") == 0) rule = RULE_STANDARD;
+        else if (strcmp(f->value, "simple") == 0) rule = RULE_NO_FORBIDDEN;
+        else return "\"rule\" must be \"std\" or \"simple\"";
+    }
+
+    initGame(&job->game, MODE_PVE, rule);
+    const JsonField *moves = jsonGet(req, "moves"), *board = jsonGet(req, "board");
+    const char *err = NULL;
+    if (moves && board) return "give either \"moves\" or \"board\"";
+    if (moves) err = parseMoves(moves->value, &job->game);
+    else if (board) err = parseBoard(board->value, jsonGet(req, "side"), &job->game);
+    if (err) return err;
+
+    job->limits = (SearchLimits){serve_options->max_depth, 0, serve_options->max_nodes, serve_options->max_time,
+                                 NULL, NULL, 0};
+    if ((f = jsonGet(req, "depth"))) {
+        if (!jsonNumber(f, &v) || v < 1) return "\"depth\" must be a positive number";
+        job->limits.max_depth = (int)v;
+    }
+    if ((f = jsonGet(req, "nodes"))) {
+        if (!jsonNumber(f, &v) || v < 0) return "\"nodes\" must be a number";
+        job->limits.max_nodes = (unsigned long long)v;
+    }
+    if ((f = jsonGet(req, "movetime"))) {
+        if (!jsonNumber(f, &v) || v < 0) return "\"movetime\" must be a number of milliseconds";
+        job->limits.max_time = v / 1000.0;
+    }
+    job->multipv = 1;
+    if ((f = jsonGet(req, "multipv"))) {
+        if (!jsonNumber(f, &v) || v < 1) return "\"multipv\" must be a positive number";
+        job->multipv = (v > SERVE_MAX_MULTIPV) ? SERVE_MAX_MULTIPV : (int)v;
+    }
+    job->use_book = !((f = jsonGet(req, "book")) && strcmp(f->value, "false") == 0);
+    job->clear = (f = jsonGet(req, "clear")) && strcmp(f->value, "true") == 0;
+    job->stream = (f = jsonGet(req, "info")) && strcmp(f->value, "true") == 0;
+    return NULL;
+}
+
+// 把请求中的 id（或 stop 的 target）编码好放回回复；编码后放不下时返回0，不截断（截断会留下没有结束的字符串）
+static int encodeId(const JsonObject *req, const char *key, char *out, size_t size) {
+    const JsonField *f = jsonGet(req, key);
+    Output o = {out, size, 0};
+    out[0] = 0;
+    if (!f) return 1;
+    double v;
+    if (f->is_string) emitString(&o, f->value);
+    else if (jsonNumber(f, &v)) emit(&o, "%s", f->value);
+    // emit 写满时停在 size - 1，恰好写到这里的也当作放不下
+    if (o.len + 1 >= size) {
+        out[0] = 0;
+        return 0;
+    }
+    return 1;
+}
+
+// ---- 连接 ----
+
+static void sendAll(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return; // 对方已断开，剩下的请求照常处理完再关闭
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+static const char *statusText(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 413: return "Payload Too Large";
+    default: return "Service Unavailable";
+    }
+}
+
+// 写一条回复，调用方持有 c->lock
+static void writeReply(Client *c, int status, const char *body) {
+    if (c->http) {
+        char head[256];
+        int n = snprintf(head, sizeof(head),
+                         "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\nConnection: %s\r\n\r\n",
+                         status, statusText(status), strlen(body) + 1, c->keep_alive ? "keep-alive" : "close");
+        sendAll(c->fd, head, (size_t)n);
+    }
+    sendAll(c->fd, body, strlen(body));
+    sendAll(c->fd, "\n", 1);
+}
+
+static void replyNow(Client *c, int status, const char *body) {
+    pthread_mutex_lock(&c->lock);
+    writeReply(c, status, body);
+    pthread_mutex_unlock(&c->lock);
+}
+
+static void replyError(Client *c, int status, const char *id, const char *message) {
+    char body[512];
+    Output o = {body, sizeof(body), 0};
+    emit(&o, "{");
+    if (id[0]) emit(&o, "\"id\":%s,", id);
+    emit(&o, "\"error\":");
+    emitString(&o, message);
+    emit(&o, "}");
+    replyNow(c, status, body);
+}
+
+// 工作线程写出回复；pending 归零后读线程才可能释放连接，所以解锁后不能再访问 c
+static void deliver(Client *c, const char *body) {
+    pthread_mutex_lock(&c->lock);
+    writeReply(c, 200, body);
+    if (--c->pending == 0) pthread_cond_broadcast(&c->idle);
+    pthread_mutex_unlock(&c->lock);
+}
+
+// ---- 调度 ----
+
+static void appendReady(Client *c) {
+    c->next_ready = NULL;
+    c->ready = 1;
+    if (pool.ready_tail) pool.ready_tail->next_ready = c;
+    else pool.ready_head = c;
+    pool.ready_tail = c;
+}
+
+// 排队，超过上限时返回0
+static int submit(Client *c, Job *job) {
+    pthread_mutex_lock(&pool.lock);
+    if (pool.queued >= serve_options->queue_limit) {
+        pool.rejected++;
+        pthread_mutex_unlock(&pool.lock);
+        return 0;
+    }
+    pthread_mutex_lock(&c->lock);
+    c->pending++;
+    pthread_mutex_unlock(&c->lock);
+
+    job->next = NULL;
+    job->client = c;
+    if (c->tail) c->tail->next = job;
+    else c->head = job;
+    c->tail = job;
+    if (!c->ready) appendReady(c);
+    pool.queued++;
+    pthread_cond_signal(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+    return 1;
+}
+
+// 轮到的连接取出一个请求后排到队尾，同一连接的请求按顺序处理
+static Job *takeJob(Worker *w) {
+    pthread_mutex_lock(&pool.lock);
+    while (!pool.ready_head) pthread_cond_wait(&pool.wake, &pool.lock);
+    Client *c = pool.ready_head;
+    pool.ready_head = c->next_ready;
+    if (!pool.ready_head) pool.ready_tail = NULL;
+    Job *job = c->head;
+    c->head = job->next;
+    if (!c->head) c->tail = NULL;
+    if (c->head) appendReady(c);
+    else c->ready = 0;
+    pool.queued--;
+    w->job = job;
+    // 在分配任务的同一把锁下清除停止标志：之后 stopRequests 找到这个任务时发出的停止请求一定有效
+    engine_clear_stop(w->engine);
+    pthread_mutex_unlock(&pool.lock);
+    return job;
+}
+
+static void unlinkReady(Client *c) {
+    Client **link = &pool.ready_head, *prev = NULL;
+    while (*link && *link != c) {
+        prev = *link;
+        link = &(*link)->next_ready;
+    }
+    if (!*link) return;
+    *link = c->next_ready;
+    if (pool.ready_tail == c) pool.ready_tail = prev;
+    c->ready = 0;
+}
+
+// 停止连接 c 上 id 为 target（NULL 为全部）的请求：排队中的直接移除，notify 时回复 "stopped"；
+// 正在搜索的在 1024 个节点内停下，照常回复最后完成的迭代的结果。返回涉及的请求数
+static int stopRequests(Client *c, const char *target, int notify) {
+    Job *removed = NULL;
+    int count = 0, dropped = 0;
+    pthread_mutex_lock(&pool.lock);
+    for (Job **link = &c->head, *prev = NULL; *link;) {
+        Job *job = *link;
+        if (target && strcmp(job->id, target) != 0) {
+            prev = job;
+            link = &job->next;
+            continue;
+        }
+        *link = job->next;
+        if (c->tail == job) c->tail = prev;
+        job->next = removed;
+        removed = job;
+        pool.queued--;
+        dropped++;
+    }
+    if (!c->head && c->ready) unlinkReady(c);
+    for (int i = 0; i < pool.workers; i++) {
+        Job *job = pool.worker_list[i].job;
+        if (job && job->client == c && (!target || strcmp(job->id, target) == 0)) {
+            atomic_store(&job->cancelled, 1);
+            engine_stop(pool.worker_list[i].engine);
+            count++;
+        }
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    while (removed) {
+        Job *job = removed;
+        removed = job->next;
+        if (notify) replyError(c, 200, job->id, "stopped");
+        free(job);
+    }
+    if (dropped) {
+        pthread_mutex_lock(&c->lock);
+        c->pending -= dropped;
+        if (c->pending == 0) pthread_cond_broadcast(&c->idle);
+        pthread_mutex_unlock(&c->lock);
+    }
+    return count + dropped;
+}
+
+static void recordLatency(double ms, int from_book, int failed) {
+    pthread_mutex_lock(&pool.lock);
+    pool.served++;
+    pool.book_hits += from_book;
+    pool.failed += failed;
+    pool.latency[pool.latency_next] = ms;
+    pool.latency_next = (pool.latency_next + 1) % SERVE_LATENCY_WINDOW;
+    if (pool.latency_count < SERVE_LATENCY_WINDOW) pool.latency_count++;
+    pthread_mutex_unlock(&pool.lock);
+}
+
+static int compareDouble(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void statsReply(Client *c, const char *id) {
+    static double sorted[SERVE_LATENCY_WINDOW];
+    static pthread_mutex_t sorted_lock = PTHREAD_MUTEX_INITIALIZER;
+    char body[1024];
+    Output o = {body, sizeof(body), 0};
+
+    pthread_mutex_lock(&sorted_lock);
+    pthread_mutex_lock(&pool.lock);
+    int n = pool.latency_count;
+    memcpy(sorted, pool.latency, n * sizeof(double));
+    emit(&o, "{");
+    if (id[0]) emit(&o, "\"id\":%s,", id);
+    emit(&o, "\"workers\":%d,\"queued\":%d,\"served\":%llu,\"book_hits\":%llu,\"rejected\":%llu,\"errors\":%llu,"
+         "\"uptime_s\":%.1f,",
+         pool.workers, pool.queued, pool.served, pool.book_hits, pool.rejected, pool.failed,
+         now_seconds() - pool.started);
+    pthread_mutex_unlock(&pool.lock);
+
+    qsort(sorted, n, sizeof(double), compareDouble);
+    emit(&o, "\"latency_ms\":{\"window\":%d,\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f,\"max\":%.2f}}", n,
+         n ? sorted[n / 2] : 0, n ? sorted[n * 9 / 10] : 0, n ? sorted[n * 99 / 100] : 0, n ? sorted[n - 1] : 0);
+    pthread_mutex_unlock(&sorted_lock);
+    replyNow(c, 200, body);
+}
+
+// ---- 工作线程 ----
+
+// 请求带 "info": true 时每完成一次迭代发送一行进度
+static void streamInfo(const SearchInfo *info, void *user) {
+    Job *job = (Job *)user;
+    char body[1024];
+    Output o = {body, sizeof(body), 0};
+    emit(&o, "{");
+    if (job->id[0]) emit(&o, "\"id\":%s,", job->id);
+    emit(&o, "\"info\":{\"line\":%d,\"depth\":%d,\"score\":%d,\"nodes\":%llu,\"nps\":%.0f,\"hashfull\":%d,"
+         "\"time_ms\":%.1f,\"pv\":[",
+         job->line, info->depth, info->score, info->nodes, info->nps, info->hashfull, info->time * 1000);
+    for (int i = 0; i < info->pv_length; i++) {
+        if (i) emit(&o, ",");
+        emitMove(&o, info->pv[i]);
+    }
+    emit(&o, "]}}");
+    replyNow(job->client, 200, body);
+}
+
+static void runJob(Worker *w, Job *job) {
+    Engine *engine = w->engine;
+    char body[SERVE_RESPONSE_MAX];
+    Output o = {body, sizeof(body), 0};
+    double start = now_seconds();
+    BookMove book_moves[SERVE_MAX_MULTIPV];
+    int from_book = job->use_book ? bookProbe(&book, &job->game, book_moves, job->multipv) : 0;
+    int failed = 0;
+
+    emit(&o, "{");
+    if (job->id[0]) emit(&o, "\"id\":%s,", job->id);
+    if (from_book) {
+        emit(&o, "\"bestmove\":");
+        emitMove(&o, book_moves[0].move);
+        emit(&o, ",\"source\":\"book\",\"lines\":[");
+        for (int k = 0; k < from_book; k++) {
+            emit(&o, "%s{\"move\":", k ? "," : "");
+            emitMove(&o, book_moves[k].move);
+            emit(&o, ",\"count\":%u", book_moves[k].count);
+            // 胜局数只在有已知胜负的对局时给出
+            if (book_moves[k].decided) emit(&o, ",\"decided\":%u,\"wins\":%u", book_moves[k].decided, book_moves[k].wins);
+            emit(&o, "}");
+        }
+        emit(&o, "],");
+    } else {
+        // 多主变：每条在排除前面找到的根走法后重新搜索，置换表在各次之间保留
+        Position excluded[SERVE_MAX_MULTIPV];
+        SearchResult results[SERVE_MAX_MULTIPV];
+        unsigned long long nodes = 0;
+        int lines = 0;
+        engine_set_game(engine, &job->game);
+        engine_set_info_callback(engine, job->stream ? streamInfo : NULL, job);
+        if (job->clear) engine_clear(engine);
+        for (int k = 0; k < job->multipv && !atomic_load(&job->cancelled); k++) {
+            job->line = k + 1;
+            SearchLimits limits = job->limits;
+            limits.exclude = excluded;
+            limits.exclude_count = k;
+            Position move = engine_search(engine, &limits, &results[k]);
+            if (move.row < 0) break;
+            excluded[k] = move;
+            nodes += results[k].nodes;
+            lines++;
+        }
+        if (lines == 0 && atomic_load(&job->cancelled)) {
+            emit(&o, "\"error\":\"stopped\",");
+        } else if (lines == 0) {
+            emit(&o, "\"error\":\"no legal move\",");
+            failed = 1;
+        } else {
+            emit(&o, "\"bestmove\":");
+            emitMove(&o, excluded[0]);
+            emit(&o, ",\"score\":%d,\"depth\":%d,\"nodes\":%llu,\"source\":\"search\",\"lines\":[", results[0].score,
+                 results[0].depth, nodes);
+            for (int k = 0; k < lines; k++) {
+                emit(&o, "%s{\"move\":", k ? "," : "");
+                emitMove(&o, excluded[k]);
+                emit(&o, ",\"score\":%d,\"depth\":%d,\"nodes\":%llu}", results[k].score, results[k].depth,
+                     results[k].nodes);
+            }
+            emit(&o, "],");
+        }
+    }
+    double end = now_seconds();
+    emit(&o, "\"time_ms\":%.1f,\"queue_ms\":%.1f}", (end - start) * 1000, (start - job->submitted) * 1000);
+
+    Client *c = job->client;
+    double latency = (end - job->submitted) * 1000;
+    pthread_mutex_lock(&pool.lock);
+    w->job = NULL;
+    pthread_mutex_unlock(&pool.lock);
+    free(job);
+    deliver(c, body);
+    recordLatency(latency, from_book > 0, failed);
+}
+
+static void *workerMain(void *arg) {
+    Worker *w = (Worker *)arg;
+    for (;;) runJob(w, takeJob(w));
+    return NULL;
+}
+
+// ---- 请求处理 ----
+
+// 解析并提交一个请求，立即可以回复的（出错、统计、排队已满）直接回复
+static void handleRequest(Client *c, const char *text) {
+    JsonObject req;
+    char id[SERVE_ID_MAX];
+    const char *err = parseJson(text, &req);
+    if (err) {
+        replyError(c, 400, "", err);
+        return;
+    }
+    if (!encodeId(&req, "id", id, sizeof(id))) {
+        replyError(c, 400, "", "\"id\" is too long");
+        return;
+    }
+
+    const JsonField *cmd = jsonGet(&req, "cmd");
+    if (cmd && strcmp(cmd->value, "stats") == 0) {
+        statsReply(c, id);
+        return;
+    }
+    if (cmd && strcmp(cmd->value, "stop") == 0) {
+        // 停止本连接上 id 为 target 的请求，没有 target 时停止全部
+        char target[SERVE_ID_MAX], body[128];
+        if (!encodeId(&req, "target", target, sizeof(target))) {
+            replyError(c, 400, id, "\"target\" is too long");
+            return;
+        }
+        int n = stopRequests(c, jsonGet(&req, "target") ? target : NULL, 1);
+        Output o = {body, sizeof(body), 0};
+        emit(&o, "{");
+        if (id[0]) emit(&o, "\"id\":%s,", id);
+        emit(&o, "\"stopped\":%d}", n);
+        replyNow(c, 200, body);
+        return;
+    }
+    if (cmd && strcmp(cmd->value, "analyze") != 0) {
+        replyError(c, 400, id, "unknown \"cmd\"");
+        return;
+    }
+
+    Job *job = (Job *)malloc(sizeof(Job));
+    if (!job) {
+        replyError(c, 503, id, "out of memory");
+        return;
+    }
+    if ((err = buildJob(&req, job))) {
+        free(job);
+        replyError(c, 400, id, err);
+        return;
+    }
+    strcpy(job->id, id);
+    job->stream = job->stream && !c->http;
+    atomic_init(&job->cancelled, 0);
+    job->submitted = now_seconds();
+    if (!submit(c, job)) {
+        free(job);
+        replyError(c, 503, id, "busy");
+    }
+}
+
+static void waitIdle(Client *c) {
+    pthread_mutex_lock(&c->lock);
+    while (c->pending > 0) pthread_cond_wait(&c->idle, &c->lock);
+    pthread_mutex_unlock(&c->lock);
+}
+
+// Unix 套接字：每行一个请求
+static void serveLines(Client *c) {
+    char buf[SERVE_REQUEST_MAX];
+    size_t len = 0;
+    for (;;) {
+        char *nl = memchr(buf, '\n', len);
+        if (!nl) {
+            if (len == sizeof(buf)) {
+                replyError(c, 413, "", "request too long");
+                return;
+            }
+            ssize_t n = recv(c->fd, buf + len, sizeof(buf) - len, 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return;
+            len += (size_t)n;
+            continue;
+        }
+        *nl = 0;
+        if (*skipSpace(buf)) handleRequest(c, buf);
+        len -= (size_t)(nl + 1 - buf);
+        memmove(buf, nl + 1, len);
+    }
+}
+
+static const char *findHeaderEnd(const char *buf, size_t len) {
+    for (size_t i = 0; i + 3 < len; i++) {
+        if (memcmp(buf + i, "\r\n\r\n", 4) == 0) return buf + i + 4;
+    }
+    return NULL;
+}
+
+// 在头部中找一个字段（不区分大小写），返回值的起始位置
+static const char *headerValue(const char *headers, const char *name) {
+    size_t n = strlen(name);
+    for (const char *line = headers; line && *line; line = strchr(line, '\n')) {
+        if (*line == '\n') line++;
+        if (strncasecmp(line, name, n) == 0 && line[n] == ':') return skipSpace(line + n + 1);
+    }
+    return NULL;
+}
+
+// HTTP/1.1：POST /analyze，GET /stats，每个连接同时只处理一个请求
+static void serveHttp(Client *c) {
+    char buf[SERVE_REQUEST_MAX + 1];
+    size_t len = 0;
+    for (;;) {
+        const char *body;
+        while (!(body = findHeaderEnd(buf, len))) {
+            if (len == SERVE_REQUEST_MAX) {
+                c->keep_alive = 0;
+                replyError(c, 413, "", "request too long");
+                return;
+            }
+            ssize_t n = recv(c->fd, buf + len, SERVE_REQUEST_MAX - len, 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return;
+            len += (size_t)n;
+        }
+        size_t head_len = (size_t)(body - buf);
+        buf[head_len - 2] = 0; // 头部以 "\r\n" 结尾，方便逐行查找
+
+        char method[8] = {0}, path[64] = {0}, version[16] = {0};
+        sscanf(buf, "%7s %63s %15s", method, path, version);
+        const char *value = headerValue(buf, "Content-Length");
+        size_t body_len = value ? strtoul(value, NULL, 10) : 0;
+        value = headerValue(buf, "Connection");
+        c->keep_alive = value ? (strncasecmp(value, "keep-alive", 10) == 0)
+                              : (strcmp(version, "HTTP/1.1") == 0);
+        if (value && strncasecmp(value, "close", 5) == 0) c->keep_alive = 0;
+
+        if (head_len + body_len > SERVE_REQUEST_MAX) {
+            c->keep_alive = 0;
+            replyError(c, 413, "", "request too long");
+            return;
+        }
+        while (len < head_len + body_len) {
+            ssize_t n = recv(c->fd, buf + len, SERVE_REQUEST_MAX - len, 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return;
+            len += (size_t)n;
+        }
+        char saved = buf[head_len + body_len];
+        buf[head_len + body_len] = 0;
+
+        if (strcmp(method, "POST") == 0 && (strcmp(path, "/analyze") == 0 || strcmp(path, "/") == 0)) {
+            handleRequest(c, buf + head_len);
+            waitIdle(c);
+        } else if (strcmp(method, "GET") == 0 && strcmp(path, "/stats") == 0) {
+            statsReply(c, "");
+        } else {
+            replyError(c, 404, "", "use POST /analyze or GET /stats");
+        }
+
+        buf[head_len + body_len] = saved;
+        len -= head_len + body_len;
+        memmove(buf, buf + head_len + body_len, len);
+        if (!c->keep_alive) return;
+    }
+}
+
+static void *clientMain(void *arg) {
+    Client *c = (Client *)arg;
+    if (c->http) serveHttp(c);
+    else serveLines(c);
+    // 对方已断开：丢掉排队的请求，停下正在搜索的，等它们回复完再关闭
+    stopRequests(c, NULL, 0);
+    waitIdle(c);
+    close(c->fd);
+    pthread_mutex_destroy(&c->lock);
+    pthread_cond_destroy(&c->idle);
+    free(c);
+    return NULL;
+}
+
+// ---- 监听 ----
+
+static int listenOn(const char *address, int *http) {
+    int fd;
+    if (strncmp(address, "unix:", 5) == 0) {
+        struct sockaddr_un addr;
+        const char *path = address + 5;
+        *http = 0;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (strlen(path) == 0 || strlen(path) >= sizeof(addr.sun_path)) {
+            fprintf(stderr, "serve: bad socket path \"%s\"\n", path);
+            return -1;
+        }
+        strcpy(addr.sun_path, path);
+        unlink(path); // 上次异常退出留下的套接字文件
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 128) < 0) {
+            perror("serve");
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    struct sockaddr_in addr;
+    char host[64] = "127.0.0.1";
+    const char *colon = strrchr(address, ':');
+    int port = atoi(colon ? colon + 1 : address);
+    *http = 1;
+    if (colon && (size_t)(colon - address) < sizeof(host)) {
+        memcpy(host, address, colon - address);
+        host[colon - address] = 0;
+        if (strcmp(host, "localhost") == 0) strcpy(host, "127.0.0.1");
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (port <= 0 || port > 65535 || inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        fprintf(stderr, "serve: bad address \"%s\"\n", address);
+        return -1;
+    }
+    int one = 1;
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd >= 0) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 128) < 0) {
+        perror("serve");
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void onSignal(int sig) {
+    (void)sig;
+    serve_stop = 1;
+}
+
+int runServer(const ServeOptions *options) {
+    int http;
+    serve_options = options;
+
+    // 开局库在工作线程启动前读完，之后只读
+    bookInit(&book, options->book_ply);
+    for (int i = 0; i < options->book_count; i++) {
+        long long games = bookAddFile(&book, options->book_paths[i], options->rule);
+        if (games < 0) {
+            fprintf(stderr, "serve: cannot read book %s\n", options->book_paths[i]);
+            return 0;
+        }
+    }
+    bookFinish(&book);
+
+    int listener = listenOn(options->address, &http);
+    if (listener < 0) return 0;
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.wake, NULL);
+
+    // 信号只在主线程等待连接时处理，其余线程继承屏蔽字
+    sigset_t block, wait_mask;
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onSignal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    sigaddset(&block, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &block, &wait_mask);
+
+    // 每个工作线程一个引擎，置换表在启动时分配并清零（页面在此时就映射好）
+    int workers = options->workers > 0 ? options->workers : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (workers < 1) workers = 1;
+    EngineConfig config;
+    engine_default_config(&config);
+    config.tt_mb = options->tt_mb;
+    pool.started = now_seconds();
+    pool.worker_list = (Worker *)calloc(workers, sizeof(Worker));
+    if (!pool.worker_list) return 0;
+    for (int i = 0; i < workers; i++) {
+        Worker *w = &pool.worker_list[i];
+        pthread_t thread;
+        if (!(w->engine = engine_new(&config))) {
+            fprintf(stderr, "serve: cannot allocate the transposition table\n");
+            return 0;
+        }
+        engine_clear(w->engine);
+        if (pthread_create(&thread, NULL, workerMain, w) != 0) {
+            fprintf(stderr, "serve: cannot start worker threads\n");
+            return 0;
+        }
+        pthread_detach(thread);
+        pool.workers++;
+    }
+    printf("serve: listening on %s (%s), %d engines x %d MB, book: %lld games, %zu entries\n", options->address,
+           http ? "HTTP" : "unix socket", workers, options->tt_mb, book.games, book.count);
+    fflush(stdout);
+
+    while (!serve_stop) {
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(listener, &fds);
+        // 等待期间才放开 SIGINT / SIGTERM
+        if (pselect(listener + 1, &fds, NULL, NULL, NULL, &wait_mask) < 0) {
+            if (errno == EINTR) continue;
+            perror("serve");
+            break;
+        }
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) continue;
+
+        Client *c = (Client *)calloc(1, sizeof(Client));
+        pthread_t thread;
+        if (!c) {
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->http = http;
+        pthread_mutex_init(&c->lock, NULL);
+        pthread_cond_init(&c->idle, NULL);
+        if (pthread_create(&thread, NULL, clientMain, c) != 0) {
+            close(fd);
+            pthread_mutex_destroy(&c->lock);
+            pthread_cond_destroy(&c->idle);
+            free(c);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+
+    close(listener);
+    if (!http) unlink(options->address + 5);
+    pthread_mutex_lock(&pool.lock);
+    printf("serve: stopped after %llu requests (%llu from the book, %llu rejected)\n", pool.served, pool.book_hits,
+           pool.rejected);
+    pthread_mutex_unlock(&pool.lock);
+    return 1;
+}
@@ -19,7 +19,6 @@ int start_helper(GameState *game) {
     int round = game->moveCount + 1; // 1-based
     Player player_turn = game->currentPlayer;
 
-    CellState (*inner)[BOARD_SIZE] = (CellState (*)[BOARD_SIZE])game->board;
     int row_now_global = game->lastMove.row;
     int col_now_global = game->lastMove.col;
 
@@ -28,7 +27,7 @@ int start_helper(GameState *game) {
     }
     else if (round == 2)
     {
-        if (inner[7][7] == BLACK)
+        if (getCell(game, 7, 7) == BLACK)
             return record_position(game, round, player_turn, 6, 7);
 
         else if (row_now_global < 3 && col_now_global > 3 && col_now_global < 11)
@@ -53,33 +52,33 @@ int start_helper(GameState *game) {
     }
     else if (round == 3)
     {
-        if (inner[7][7] == BLACK)
+        if (getCell(game, 7, 7) == BLACK)
         {
-            if (inner[0][0] == WHITE || inner[0][14] == WHITE || inner[14][0] == WHITE || inner[14][14] == WHITE)
+            if (getCell(game, 0, 0) == WHITE || getCell(game, 0, 14) == WHITE || getCell(game, 14, 0) == WHITE || getCell(game, 14, 14) == WHITE)
                 return record_position(game, round, player_turn, 7, 8);
 
-            else if (inner[6][7] == WHITE || inner[7][8] == WHITE)
+            else if (getCell(game, 6, 7) == WHITE || getCell(game, 7, 8) == WHITE)
                 return record_position(game, round, player_turn, 6, 8);
-            else if (inner[7][6] == WHITE || inner[8][7] == WHITE)
+            else if (getCell(game, 7, 6) == WHITE || getCell(game, 8, 7) == WHITE)
                 return record_position(game, round, player_turn, 8, 6);
 
-            else if (inner[6][6] == WHITE || inner[8][8] == WHITE)
+            else if (getCell(game, 6, 6) == WHITE || getCell(game, 8, 8) == WHITE)
                 return record_position(game, round, player_turn, 8, 6);
-            else if (inner[8][6] == WHITE || inner[6][8] == WHITE)
+            else if (getCell(game, 8, 6) == WHITE || getCell(game, 6, 8) == WHITE)
                 return record_position(game, round, player_turn, 6, 6);
 
-            else if (inner[5][7] == WHITE)
+            else if (getCell(game, 5, 7) == WHITE)
                 return record_position(game, round, player_turn, 8, 7);
-            else if (inner[9][7] == WHITE)
+            else if (getCell(game, 9, 7) == WHITE)
                 return record_position(game, round, player_turn, 6, 7);
-            else if (inner[7][5] == WHITE)
+            else if (getCell(game, 7, 5) == WHITE)
                 return record_position(game, round, player_turn, 7, 8);
-            else if (inner[7][9] == WHITE)
+            else if (getCell(game, 7, 9) == WHITE)
                 return record_position(game, round, player_turn, 7, 6);
 
-            else if (inner[5][5] == WHITE || inner[9][9] == WHITE)
+            else if (getCell(game, 5, 5) == WHITE || getCell(game, 9, 9) == WHITE)
                 return record_position(game, round, player_turn, 6, 8);
-            else if (inner[5][9] == WHITE || inner[9][5] == WHITE)
+            else if (getCell(game, 5, 9) == WHITE || getCell(game, 9, 5) == WHITE)
                 return record_position(game, round, player_turn, 6, 6);
             else
                 return 0;
@@ -89,40 +88,40 @@ int start_helper(GameState *game) {
     }
     else if (round == 4)
     {
-        if (inner[7][7] == BLACK && inner[6][7] == WHITE)
+        if (getCell(game, 7, 7) == BLACK && getCell(game, 6, 7) == WHITE)
         {
-            if (inner[6][6] == BLACK)
+            if (getCell(game, 6, 6) == BLACK)
                 return record_position(game, round, player_turn, 7, 6);
-            else if (inner[6][8] == BLACK)
+            else if (getCell(game, 6, 8) == BLACK)
                 return record_position(game, round, player_turn, 7, 8);
 
-            else if (inner[7][6] == BLACK)
+            else if (getCell(game, 7, 6) == BLACK)
                 return record_position(game, round, player_turn, 7, 5);
-            else if (inner[7][8] == BLACK)
+            else if (getCell(game, 7, 8) == BLACK)
                 return record_position(game, round, player_turn, 7, 9);
 
-            else if (inner[8][6] == BLACK)
+            else if (getCell(game, 8, 6) == BLACK)
                 return record_position(game, round, player_turn, 6, 8);
-            else if (inner[8][8] == BLACK)
+            else if (getCell(game, 8, 8) == BLACK)
                 return record_position(game, round, player_turn, 6, 6);
 
-            else if (inner[8][7] == BLACK)
+            else if (getCell(game, 8, 7) == BLACK)
                 return record_position(game, round, player_turn, 9, 7);
 
-            else if (inner[9][7] == BLACK)
+            else if (getCell(game, 9, 7) == BLACK)
                 return record_position(game, round, player_turn, 5, 6);
 
-            else if (inner[5][7] == BLACK)
+            else if (getCell(game, 5, 7) == BLACK)
                 return record_position(game, round, player_turn, 6, 6);
 
-            else if (inner[7][5] == BLACK)
+            else if (getCell(game, 7, 5) == BLACK)
                 return record_position(game, round, player_turn, 7, 6);
-            else if (inner[7][9] == BLACK)
+            else if (getCell(game, 7, 9) == BLACK)
                 return record_position(game, round, player_turn, 7, 8);
 
-            else if (inner[5][5] == BLACK)
+            else if (getCell(game, 5, 5) == BLACK)
                 return record_position(game, round, player_turn, 6, 6);
-            else if (inner[5][9] == BLACK)
+            else if (getCell(game, 5, 9) == BLACK)
                 return record_position(game, round, player_turn, 6, 8);
 
             else
@@ -134,100 +133,100 @@ int start_helper(GameState *game) {
     else if (round == 5)
     {
         // 花月
-        if (inner[7][7] == BLACK && inner[6][7] == WHITE && inner[6][8] == BLACK)
+        if (getCell(game, 7, 7) == BLACK && getCell(game, 6, 7) == WHITE && getCell(game, 6, 8) == BLACK)
         {
-            if (inner[7][8] == WHITE)
+            if (getCell(game, 7, 8) == WHITE)
                 return record_position(game, round, player_turn, 8, 9);
-            else if (inner[5][9] == WHITE)
+            else if (getCell(game, 5, 9) == WHITE)
                 return record_position(game, round, player_turn, 8, 6);
-            else if (inner[8][6] == WHITE)
+            else if (getCell(game, 8, 6) == WHITE)
                 return record_position(game, round, player_turn, 5, 9);
-            else if (inner[5][6] == WHITE)
+            else if (getCell(game, 5, 6) == WHITE)
                 return record_position(game, round, player_turn, 7, 8);
             else
                 return 0;
         }
-        else if (inner[7][7] == BLACK && inner[7][8] == WHITE && inner[6][8] == BLACK)
+        else if (getCell(game, 7, 7) == BLACK && getCell(game, 7, 8) == WHITE && getCell(game, 6, 8) == BLACK)
         {
-            if (inner[6][7] == WHITE)
+            if (getCell(game, 6, 7) == WHITE)
                 return record_position(game, round, player_turn, 8, 9);
-            else if (inner[5][9] == WHITE)
+            else if (getCell(game, 5, 9) == WHITE)
                 return record_position(game, round, player_turn, 8, 6);
-            else if (inner[8][6] == WHITE)
+            else if (getCell(game, 8, 6) == WHITE)
                 return record_position(game, round, player_turn, 5, 9);
-            else if (inner[8][9] == WHITE)
+            else if (getCell(game, 8, 9) == WHITE)
                 return record_position(game, round, player_turn, 6, 7);
             else
                 return 0;
         }
-        else if (inner[7][7] == BLACK && inner[7][6] == WHITE && inner[8][6] == BLACK)
+        else if (getCell(game, 7, 7) == BLACK && getCell(game, 7, 6) == WHITE && getCell(game, 8, 6) == BLACK)
         {
-            if (inner[8][7] == WHITE)
+            if (getCell(game, 8, 7) == WHITE)
                 return record_position(game, round, player_turn, 9, 8);
-            else if (inner[9][5] == WHITE)
+            else if (getCell(game, 9, 5) == WHITE)
                 return record_position(game, round, player_turn, 6, 8);
-            else if (inner[6][8] == WHITE)
+            else if (getCell(game, 6, 8) == WHITE)
                 return record_position(game, round, player_turn, 9, 5);
-            else if (inner[6][5] == WHITE)
+            else if (getCell(game, 6, 5) == WHITE)
                 return record_position(game, round, player_turn, 8, 7);
             else
                 return 0;
         }
-        else if (inner[7][7] == BLACK && inner[8][7] == WHITE && inner[8][6] == BLACK)
+        else if (getCell(game, 7, 7) == BLACK && getCell(game, 8, 7) == WHITE && getCell(game, 8, 6) == BLACK)
         {
-            if (inner[7][6] == WHITE)
+            if (getCell(game, 7, 6) == WHITE)
                 return record_position(game, round, player_turn, 9, 8);
-            else if (inner[9][5] == WHITE)
+            else if (getCell(game, 9, 5) == WHITE)
                 return record_position(game, round, player_turn, 6, 8);
-            else if (inner[6][8] == WHITE)
+            else if (getCell(game, 6, 8) == WHITE)
                 return record_position(game, round, player_turn, 9, 5);
-            else if (inner[9][8] == WHITE)
+            else if (getCell(game, 9, 8) == WHITE)
                 return record_position(game, round, player_turn, 7, 6);
             else
                 return 0;
         }
 
         // 浦月
-        else if (inner[7][7] == BLACK && inner[6][6] == WHITE && inner[8][6] == BLACK)
+        else if (getCell(game, 7, 7) == BLACK && getCell(game, 6, 6) == WHITE && getCell(game, 8, 6) == BLACK)
         {
-            if (inner[6][8] == WHITE)
+            if (getCell(game, 6, 8) == WHITE)
                 return record_position(game, round, player_turn, 8, 5);
-            else if (inner[9][5] == WHITE || inner[8][7] == WHITE || inner[9][7] == WHITE || inner[9][6] == WHITE || inner[7][5] == WHITE || inner[7][6] == WHITE)
+            else if (getCell(game, 9, 5) == WHITE || getCell(game, 8, 7) == WHITE || getCell(game, 9, 7) == WHITE || getCell(game, 9, 6) == WHITE || getCell(game, 7, 5) == WHITE || getCell(game, 7, 6) == WHITE)
                 return record_position(game, round, player_turn, 6, 8);
-            else if (inner[8][5] == WHITE)
+            else if (getCell(game, 8, 5) == WHITE)
                 return record_position(game, round, player_turn, 9, 5);
             else
                 return 0;
         }
-        else if (inner[7][7] == BLACK && inner[8][8] == WHITE && inner[8][6] == BLACK)
+        else if (getCell(game, 7, 7) == BLACK && getCell(game, 8, 8) == WHITE && getCell(game, 8, 6) == BLACK)
         {
-            if (inner[6][8] == WHITE)
+            if (getCell(game, 6, 8) == WHITE)
                 return record_position(game, round, player_turn, 9, 6);
-            else if (inner[9][5] == WHITE || inner[8][7] == WHITE || inner[9][7] == WHITE || inner[8][5] == WHITE || inner[7][5] == WHITE || inner[7][6] == WHITE)
+            else if (getCell(game, 9, 5) == WHITE || getCell(game, 8, 7) == WHITE || getCell(game, 9, 7) == WHITE || getCell(game, 8, 5) == WHITE || getCell(game, 7, 5) == WHITE || getCell(game, 7, 6) == WHITE)
                 return record_position(game, round, player_turn, 6, 8);
-            else if (inner[9][6] == WHITE)
+            else if (getCell(game, 9, 6) == WHITE)
                 return record_position(game, round, player_turn, 9, 5);
             else
                 return 0;
         }
-        else if (inner[7][7] == BLACK && inner[8][6] == WHITE && inner[6][6] == BLACK)
+        else if (getCell(game, 7, 7) == BLACK && getCell(game, 8, 6) == WHITE && getCell(game, 6, 6) == BLACK)
         {
-            if (inner[8][8] == WHITE)
+            if (getCell(game, 8, 8) == WHITE)
                 return record_position(game, round, player_turn, 6, 5);
-            else if (inner[5][5] == WHITE || inner[6][7] == WHITE || inner[5][7] == WHITE || inner[5][6] == WHITE || inner[7][5] == WHITE || inner[7][6] == WHITE)
+            else if (getCell(game, 5, 5) == WHITE || getCell(game, 6, 7) == WHITE || getCell(game, 5, 7) == WHITE || getCell(game, 5, 6) == WHITE || getCell(game, 7, 5) == WHITE || getCell(game, 7, 6) == WHITE)
                 return record_position(game, round, player_turn, 8, 8);
-            else if (inner[6][5] == WHITE)
+            else if (getCell(game, 6, 5) == WHITE)
                 return record_position(game, round, player_turn, 5, 5);
             else
                 return 0;
         }
-        else if (inner[7][7] == BLACK && inner[6][8] == WHITE && inner[6][6] == BLACK)
+        else if (getCell(game, 7, 7) == BLACK && getCell(game, 6, 8) == WHITE && getCell(game, 6, 6) == BLACK)
         {
-            if (inner[8][8] == WHITE)
+            if (getCell(game, 8, 8) == WHITE)
                 return record_position(game, round, player_turn, 5, 6);
-            else if (inner[5][5] == WHITE || inner[6][7] == WHITE || inner[5][7] == WHITE || inner[6][5] == WHITE || inner[7][5] == WHITE || inner[7][6] == WHITE)
+            else if (getCell(game, 5, 5) == WHITE || getCell(game, 6, 7) == WHITE || getCell(game, 5, 7) == WHITE || getCell(game, 6, 5) == WHITE || getCell(game, 7, 5) == WHITE || getCell(game, 7, 6) == WHITE)
                 return record_position(game, round, player_turn, 8, 8);
-            else if (inner[5][6] == WHITE)
+            else if (getCell(game, 5, 6) == WHITE)
                 return record_position(game, round, player_turn, 5, 5);
             else
                 return 0;
@@ -3,9 +3,7 @@
 #include <string.h>
 #include <stdio.h>
 
-static TTEntry* tt_table = NULL;
-static uint64_t tt_size = 0; // 表项数量
-static uint64_t tt_mask = 0; // 用于快速索引的掩码（size - 1）
+static TranspositionTable tt_global = {NULL, 0, 0};
 
 // helper 打包/解包走子
 static inline uint8_t packMove(Position p) {
@@ -18,43 +16,71 @@ static inline Position unpackMove(uint8_t packed) {
     return (Position){(packed >> 4) & 0xF, packed & 0xF};
 }
 
-void tt_init(int size_mb) {
-    if (tt_table) free(tt_table);
-    
-    // 计算表项数量
-    // 保证大小为2的幂，便于快速索引
+// 按 size_mb 分配表项，数量取不大于容量的2的幂，便于快速索引
+static int tt_alloc(TranspositionTable* tt, int size_mb) {
     uint64_t bytes = (uint64_t)size_mb * 1024 * 1024;
     uint64_t count = bytes / sizeof(TTEntry);
     
     // 找到不大于count的最近的2的幂
-    tt_size = 1;
-    while (tt_size * 2 <= count) {
-        tt_size *= 2;
+    tt->size = 1;
+    while (tt->size * 2 <= count) {
+        tt->size *= 2;
     }
-    tt_mask = tt_size - 1;
+    tt->mask = tt->size - 1;
     
-    tt_table = (TTEntry*)calloc(tt_size, sizeof(TTEntry));
-    printf("TT Initialized: %d MB, %lu entries\n", size_mb, tt_size);
+    tt->table = (TTEntry*)calloc(tt->size, sizeof(TTEntry));
+    return tt->table != NULL;
+}
+
+void tt_init(int size_mb) {
+    if (tt_global.table) free(tt_global.table);
+    tt_alloc(&tt_global, size_mb);
+    printf("TT Initialized: %d MB, %lu entries\n", size_mb, tt_global.size);
 }
 
 void tt_free() {
-    if (tt_table) {
-        free(tt_table);
-        tt_table = NULL;
+    if (tt_global.table) {
+        free(tt_global.table);
+        tt_global.table = NULL;
     }
 }
 
 void tt_clear() {
-    if (tt_table) {
-        memset(tt_table, 0, tt_size * sizeof(TTEntry));
+    tt_reset(&tt_global);
+}
+
+TranspositionTable* tt_default() {
+    return &tt_global;
+}
+
+TranspositionTable* tt_create(int size_mb) {
+    TranspositionTable* tt = (TranspositionTable*)malloc(sizeof(TranspositionTable));
+    if (!tt) return NULL;
+    if (!tt_alloc(tt, size_mb)) {
+        free(tt);
+        return NULL;
+    }
+    return tt;
+}
+
+void tt_destroy(TranspositionTable* tt) {
+    if (tt) {
+        free(tt->table);
+        free(tt);
+    }
+}
+
+void tt_reset(TranspositionTable* tt) {
+    if (tt->table) {
+        memset(tt->table, 0, tt->size * sizeof(TTEntry));
     }
 }
 
-int tt_probe(uint64_t key, int rem_depth, int* alpha, int* beta, int* out_val, Position* out_move) {
-    if (!tt_table) return 0;
+int tt_probe(TranspositionTable* tt, uint64_t key, int rem_depth, int* alpha, int* beta, int* out_val, Position* out_move) {
+    if (!tt->table) return 0;
 
-    uint64_t index = key & tt_mask;
-    TTEntry* entry = &tt_table[index];
+    uint64_t index = key & tt->mask;
+    TTEntry* entry = &tt->table[index];
 
     if (entry->key == key) {
         // 取出最佳走子用于排序
@@ -104,11 +130,11 @@ int tt_probe(uint64_t key, int rem_depth, int* alpha, int* beta, int* out_val, P
     return 0;
 }
 
-void tt_save(uint64_t key, int rem_depth, int value, int flag, Position best_move) {
-    if (!tt_table) return;
+void tt_save(TranspositionTable* tt, uint64_t key, int rem_depth, int value, int flag, Position best_move) {
+    if (!tt->table) return;
 
-    uint64_t index = key & tt_mask;
-    TTEntry* entry = &tt_table[index];
+    uint64_t index = key & tt->mask;
+    TTEntry* entry = &tt->table[index];
 
     // 替换策略：
     // 1. 如果为空（key==0）则总是替换
@@ -125,8 +151,25 @@ void tt_save(uint64_t key, int rem_depth, int value, int flag, Position best_mov
     }
 }
 
-void tt_prefetch(uint64_t key) {
-    if (!tt_table) return;
-    uint64_t index = key & tt_mask;
-    __builtin_prefetch(&tt_table[index]); // 预取缓存行
+void tt_prefetch(TranspositionTable* tt, uint64_t key) {
+    if (!tt->table) return;
+    uint64_t index = key & tt->mask;
+    __builtin_prefetch(&tt->table[index]); // 预取缓存行
+}
+
+Position tt_best_move(const TranspositionTable* tt, uint64_t key) {
+    if (!tt->table) return (Position){-1, -1};
+    const TTEntry* entry = &tt->table[key & tt->mask];
+    if (entry->key != key) return (Position){-1, -1};
+    return unpackMove((uint8_t)entry->best_move);
+}
+
+int tt_hashfull(const TranspositionTable* tt) {
+    if (!tt->table) return 0;
+    uint64_t sample = tt->size < 1000 ? tt->size : 1000;
+    uint64_t used = 0;
+    for (uint64_t i = 0; i < sample; i++) {
+        if (tt->table[i].key != 0) used++;
+    }
+    return (int)(used * 1000 / sample);
 }
@@ -34,7 +34,7 @@ uint64_t calculateZobristHash(const BitBoardState* board, Player currentPlayer)
     
     for (int i = 0; i < BOARD_SIZE; i++) {
         // 检查黑子
-        Line b_row = board->black.rows[i];
+        Line b_row = board->rows[i].black;
         for (int j = 0; j < BOARD_SIZE; j++) {
             if ((b_row >> j) & 1) {
                 hash ^= zobrist_table[i][j][0];
@@ -42,7 +42,7 @@ uint64_t calculateZobristHash(const BitBoardState* board, Player currentPlayer)
         }
         
         // 检查白子
-        Line w_row = board->white.rows[i];
+        Line w_row = board->rows[i].white;
         for (int j = 0; j < BOARD_SIZE; j++) {
             if ((w_row >> j) & 1) {
                 hash ^= zobrist_table[i][j][1];
@@ -0,0 +1,127 @@
+// 搜索基准：在固定局面上以固定深度搜索，统计节点数、每秒节点数与到达每一层的用时
+// 用法: bench [depth] [kernel]    kernel: generic / avx2 / avx512
+// 单线程、每个局面前清空置换表，同一台机器上的节点数与签名可以在提交之间直接比较；
+// 签名由每个局面的节点数、最佳走法和分数算出，搜索行为有任何变化都会改变它
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/types.h"
+#include "../include/board.h"
+#include "../include/rules.h"
+#include "../include/history.h"
+#include "../include/ai.h"
+#include "../include/evaluate.h"
+#include "../include/tt.h"
+
+// 走法序列，坐标格式同棋谱（列字母 + 行号）
+// 中盘与残局局面取自引擎自对弈的对局
+typedef struct {
+    const char *stage;
+    const char *moves;
+} BenchPosition;
+
+static const BenchPosition bench_positions[] = {
+    {"opening", "H8 H9 I8 G8 J9"},
+    {"opening", "H8 I9 G9 I7 I8 G10"},
+    {"opening", "H8 H7 I7 G9 J6 I9 G6"},
+    {"opening", "H8 J8 H9 H10 G9 F10 I9 J9 G10 G8"},
+    {"opening", "H8 I8 G7 G9 F8 H6 I7 E9 J6"},
+    {"midgame", "H8 H9 F10 G9 I9 G7 G10 H10 I11 I10 F9 F7 G8 H7 E7 J11 H11 E8"},
+    {"midgame", "H8 H9 G10 G8 I10 F7 J10 H10 I9 G7 I7 I8 G9 F10 K11 L12 J6 K5 K10 F9 F8 H7 I6 E7"},
+    {"midgame", "H8 H9 F10 G9 G8 F8 F9 H10 E7 E10 H7 G7 H6 I6 I8 J9 J8 K8 K9 I7 I11 H5 J7 I10 H11 L7 M6 J11 E8 G10"},
+    {"endgame", "H8 H9 F10 G9 I9 G7 G10 H10 I11 I10 F9 F7 G8 H7 E7 J11 H11 E8 F11 F8 G11 E11 E9 I7 J7 K12 L13 H12 "
+                "E10 I12 G12 J12 L12 D9 C10 D10"},
+    {"endgame", "H8 H9 F10 G9 G8 F8 F9 H10 E7 E10 H7 G7 H6 I6 I8 J9 J8 K8 K9 I7 I11 H5 J7 I10 H11 L7 M6 J11 E8 G10 "
+                "J10 L8 L6 K7 H12 G13 G11 E9 F11 E11 F12 F13 E12 G12 K6 J6 I5 I13 H13 D10 C11 K12 L13 H14 M4 L5 M7 M5 "
+                "K5 J4 M9 J12 K11 L12 M12 M8 N8 O9 L10 O7 K14 N11 M11 N12 M10 M13 N10 K10 I12 O6"},
+    {"endgame", "H8 H9 F10 G9 G8 F8 F9 H10 E7 E10 H7 G7 H6 I6 I8 J9 J8 K8 K9 I7 I11 H5 J7 I10 H11 L7 M6 J11 E8 G10 "
+                "J10 L8 L6 K7 H12 G13 G11 E9 F11 E11 F12 F13 E12 G12 K6 J6 I5 I13 H13 D10 C11 K12 L13 H14 M4 L5 M7 M5 "
+                "K5 J4 M9 J12 K11 L12 M12 M8 N8 O9 L10 O7 K14 N11 M11 N12 M10 M13 N10 K10 I12 O6 J13 L15 O8 L14 L9 G14 "
+                "F14 E13 D13 N6 K15 C10 L4 N4 N5 N13 N14 J5 J3 C14 B10 G4 D12 I4 H4 N9 D14 D11 F6 G5 G6 F5 E6 D6 E5 E4 "
+                "B12 C12 B13 B11"},
+    {NULL, NULL}
+};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// FNV-1a
+static unsigned long long signatureAdd(unsigned long long sig, unsigned long long value) {
+    for (int i = 0; i < 8; i++) {
+        sig ^= (value >> (i * 8)) & 0xFF;
+        sig *= 0x100000001B3ULL;
+    }
+    return sig;
+}
+
+static void setupPosition(GameState *game, const char *moves) {
+    char buf[1024];
+    initGame(game, MODE_PVE, RULE_STANDARD);
+    strncpy(buf, moves, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = 0;
+    for (char *tok = strtok(buf, " "); tok; tok = strtok(NULL, " ")) {
+        int col = tok[0] - 'A';
+        int row = BOARD_SIZE - atoi(tok + 1);
+        if (makeMove(game, row, col) != VALID_MOVE) {
+            fprintf(stderr, "bench: illegal move %s in \"%s\"\n", tok, moves);
+            exit(1);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int depth = (argc > 1) ? atoi(argv[1]) : 8;
+    SearchLimits limits = {depth, 0, 0, 0, NULL, NULL, 0};
+    unsigned long long total_nodes = 0;
+    unsigned long long signature = 0xCBF29CE484222325ULL;
+    double total_time = 0;
+
+    if (argc > 2) {
+        int found = 0;
+        for (int k = 0; k < EVAL_KERNEL_COUNT; k++) {
+            if (strcmp(argv[2], evaluateKernelName((EvalKernel)k)) == 0) {
+                found = evaluateSetKernel((EvalKernel)k);
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "bench: kernel %s is not available on this CPU\n", argv[2]);
+            return 1;
+        }
+    }
+
+    printf("backend: %s, kernel: %s, depth: %d\n", EVAL_BACKEND_NAME, evaluateKernelName(evaluateGetKernel()), depth);
+    for (int i = 0; bench_positions[i].moves; i++) {
+        GameState game;
+        SearchResult result;
+        setupPosition(&game, bench_positions[i].moves);
+        tt_clear();
+
+        double start = now_seconds();
+        aiSearch(&game, &limits, &result);
+        double elapsed = now_seconds() - start;
+
+        printf("position %d: move (%d, %d) score %d nodes %llu time %.3fs nps %.0f [%s, %d stones]\n",
+               i + 1, result.best_move.row, result.best_move.col, result.score,
+               result.nodes, elapsed, elapsed > 0 ? result.nodes / elapsed : 0,
+               bench_positions[i].stage, game.moveCount);
+        for (int k = 0; k < result.iteration_count; k++) {
+            const SearchIteration *it = &result.iterations[k];
+            printf("  depth %2d: move (%d, %d) score %d nodes %llu time %.3fs\n",
+                   it->depth, it->best_move.row, it->best_move.col, it->score, it->nodes, it->time);
+        }
+        signature = signatureAdd(signature, result.nodes);
+        signature = signatureAdd(signature, (unsigned long long)(result.best_move.row * BOARD_SIZE + result.best_move.col));
+        signature = signatureAdd(signature, (unsigned long long)(long long)result.score);
+        total_nodes += result.nodes;
+        total_time += elapsed;
+        clearHistory(&game);
+    }
+    printf("total: nodes %llu time %.3fs nps %.0f\n", total_nodes, total_time,
+           total_time > 0 ? total_nodes / total_time : 0);
+    printf("signature: %016llx\n", signature);
+    return 0;
+}
@@ -0,0 +1,58 @@
+// 构建期生成整线三进制评分表
+// 用法: gen_linetable <输出文件>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/linetable.h"
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: gen_linetable <output>\n");
+        return 1;
+    }
+
+    LineTableHeader header = {0};
+    header.magic = LINE_TABLE_MAGIC;
+    header.version = LINE_TABLE_VERSION;
+    header.entry_count = lineTableOffset(BOARD_SIZE + 1);
+    for (int len = LINE_TABLE_MIN_LEN; len <= BOARD_SIZE; len++) {
+        header.offsets[len] = lineTableOffset(len);
+    }
+
+    int *entries = (int *)malloc((size_t)header.entry_count * sizeof(int));
+    if (!entries) {
+        fprintf(stderr, "gen_linetable: out of memory\n");
+        return 1;
+    }
+
+    for (int len = LINE_TABLE_MIN_LEN; len <= BOARD_SIZE; len++) {
+        int *sub = entries + header.offsets[len];
+        unsigned int states = lineTableOffset(len + 1) - lineTableOffset(len);
+        // 逐位解码三进制下标：0=空，1=黑，2=白
+        for (unsigned int idx = 0; idx < states; idx++) {
+            Line b = 0, w = 0;
+            unsigned int t = idx;
+            for (int i = 0; i < len; i++, t /= 3) {
+                if (t % 3 == 1) b |= (1 << i);
+                else if (t % 3 == 2) w |= (1 << i);
+            }
+            sub[idx] = lineTableComputeEntry(b, w, len);
+        }
+    }
+
+    FILE *fp = fopen(argv[1], "wb");
+    if (!fp) {
+        perror("gen_linetable");
+        free(entries);
+        return 1;
+    }
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+             fwrite(entries, sizeof(int), header.entry_count, fp) == header.entry_count;
+    ok = (fclose(fp) == 0) && ok;
+    free(entries);
+    if (!ok) {
+        fprintf(stderr, "gen_linetable: failed to write %s\n", argv[1]);
+        return 1;
+    }
+    printf("line table: %u entries written to %s\n", header.entry_count, argv[1]);
+    return 0;
+}
@@ -0,0 +1,92 @@
+// importcheck：用内置的小段棋谱检查各格式导入时对局的切分、坐标换算与无效对局的剔除
+// 用法: importcheck
+// 每个用例给出输入文本、期望导入与剔除的盘数，以及导入的第一盘棋的走法（CORPUS_MOVE 编码）
+// 发现不一致时返回1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/types.h"
+#include "../include/corpus.h"
+#include "../include/interchange.h"
+
+#define MAX_CHECK_MOVES 8
+
+typedef struct {
+    const char *name;
+    GameFormat format;
+    const char *text;
+    long long games;    // 期望导入的盘数
+    long long rejected; // 期望剔除的盘数
+    int move_count;     // 期望的第一盘棋
+    unsigned char moves[MAX_CHECK_MOVES];
+} ImportCase;
+
+static const ImportCase cases[] = {
+    {"psq: two games separated by a result line", FORMAT_PSQ,
+     "Piskvork 15x15, 11:11, 0\n8,8,0\n9,9,0\n-1\n"
+     "Piskvork 15x15, 11:11, 0\n1,1,0\n-1\n",
+     2, 0, 2, {CORPUS_MOVE(7, 7), CORPUS_MOVE(8, 8)}},
+    // 两盘棋首尾相接（中间没有结果行），前一盘有越界坐标
+    {"psq: back-to-back games, first has a bad coordinate", FORMAT_PSQ,
+     "Piskvork 15x15, 11:11, 0\n8,8,0\n16,1,0\n"
+     "Piskvork 15x15, 11:11, 0\n3,4,0\n5,6,0\n-1\n",
+     1, 1, 2, {CORPUS_MOVE(3, 2), CORPUS_MOVE(5, 4)}},
+    {"psq: back-to-back games, first is not 15x15", FORMAT_PSQ,
+     "Piskvork 20x20, 11:11, 0\n8,8,0\n"
+     "Piskvork 15x15, 11:11, 0\n2,2,0\n",
+     1, 1, 1, {CORPUS_MOVE(1, 1)}},
+    {"psq: repeated move", FORMAT_PSQ,
+     "Piskvork 15x15, 11:11, 0\n8,8,0\n8,8,0\n"
+     "Piskvork 15x15, 11:11, 0\n8,8,0\n",
+     1, 1, 1, {CORPUS_MOVE(7, 7)}},
+    {"pos: one game per line", FORMAT_POSLIST,
+     "# comment\nh8i9\nH8 P1\nA1 O15\n",
+     2, 1, 2, {CORPUS_MOVE(7, 7), CORPUS_MOVE(6, 8)}},
+};
+
+typedef struct {
+    long long games;
+    CorpusGame first;
+    unsigned char first_moves[BOARD_SIZE * BOARD_SIZE];
+} Collected;
+
+static int collect(void *user, const CorpusGame *game) {
+    Collected *c = (Collected *)user;
+    if (c->games++ == 0) {
+        memcpy(c->first_moves, game->moves, game->move_count);
+        c->first = *game;
+        c->first.moves = c->first_moves;
+    }
+    return 1;
+}
+
+int main(void) {
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const ImportCase *t = &cases[i];
+        Collected c;
+        long long rejected = 0;
+        memset(&c, 0, sizeof(c));
+        FILE *fp = fmemopen((void *)t->text, strlen(t->text), "r");
+        if (!fp) {
+            perror("importcheck: fmemopen");
+            return 1;
+        }
+        long long games = importGames(fp, t->format, RULE_STANDARD, collect, &c, &rejected);
+        fclose(fp);
+
+        int ok = games == t->games && c.games == t->games && rejected == t->rejected;
+        if (ok && t->games > 0) {
+            ok = c.first.move_count == t->move_count && memcmp(c.first_moves, t->moves, t->move_count) == 0;
+        }
+        printf("%-55s %s", t->name, ok ? "ok" : "MISMATCH");
+        if (!ok) printf(" (games %lld rejected %lld, expected %lld / %lld)", games, rejected, t->games, t->rejected);
+        printf("\n");
+        failures += !ok;
+    }
+    if (failures) {
+        printf("\n%d mismatches\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,507 @@
+// 自对弈比赛：两个使用 Gomocup 协议的引擎（通常是用不同编译参数构建的本程序）对下多盘棋，
+// 每个开局双方各执黑一次，多盘并行，最后给出 Elo、95% 误差范围与 SPRT 结论
+// 用法: gomoku-match [选项]
+//   --engine1 <命令> / --engine2 <命令>  引擎命令行（经 /bin/sh 执行），默认 "./build/gomoku --protocol gomocup"
+//   --games <N>                         总盘数（默认 100）
+//   --concurrency <K>                   同时进行的盘数（默认为 CPU 数）
+//   --openings <文件>                   开局库（interchange.h 支持的格式），默认使用26种连珠开局
+//   --movetime <毫秒> | --nodes <N>     每步的时间或节点预算（默认 100 毫秒）
+//   --rules <std|simple>                规则（默认 std）
+//   --sprt <elo0> <elo1> [alpha beta]   SPRT 假设（默认 0 5 0.05 0.05），结论确定后不再开新局
+//   --out <文件>                        保存所有对局（格式按扩展名）
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "../include/types.h"
+#include "../include/board.h"
+#include "../include/rules.h"
+#include "../include/corpus.h"
+#include "../include/interchange.h"
+
+#define MAX_MOVES (BOARD_SIZE * BOARD_SIZE)
+#define MAX_OPENINGS 4096
+#define DEFAULT_ENGINE "./build/gomoku --protocol gomocup"
+// 超时判负前额外宽限的时间（毫秒），按节点限制时每步最多等待的时间
+#define MOVE_GRACE_MS 2000
+#define NODES_MOVE_TIMEOUT_MS 60000
+
+// 对局结果（引擎1视角的得分 x2）
+#define RESULT_LOSS 0
+#define RESULT_DRAW 1
+#define RESULT_WIN 2
+#define RESULT_ERROR 3
+
+typedef struct {
+    const char *engine[2];
+    int games;
+    int concurrency;
+    int movetime;
+    unsigned long long nodes;
+    RuleType rule;
+    double elo0, elo1, alpha, beta;
+    const char *openings_path;
+    const char *out_path;
+} MatchOptions;
+
+typedef struct {
+    unsigned char moves[8];
+    int count;
+} Opening;
+
+static Opening openings[MAX_OPENINGS];
+static int opening_count = 0;
+
+// 一个引擎子进程
+typedef struct {
+    pid_t pid;
+    int to_fd;    // 写入引擎 stdin
+    int from_fd;  // 读取引擎 stdout
+    char buf[1024];
+    int len;
+    int synced;   // 是否已经用 BOARD 发过局面
+} Engine;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// --- 开局库 ---
+
+// 默认开局：黑 H8，白走直指 H9 或斜指 I9，黑第3手在中心 5x5 内，去掉对称重复后共 26 种
+static void generateOpenings(void) {
+    const int center = BOARD_SIZE / 2;
+    for (int indirect = 0; indirect <= 1; indirect++) {
+        int wr = center - 1, wc = center + indirect;
+        for (int r = center - 2; r <= center + 2; r++) {
+            for (int c = center - 2; c <= center + 2; c++) {
+                if ((r == center && c == center) || (r == wr && c == wc)) continue;
+                // 保持前两子不动的镜像：直指关于 H 列对称，斜指关于过两子的斜线对称
+                int mr = indirect ? (BOARD_SIZE - 1 - c) : r;
+                int mc = indirect ? (BOARD_SIZE - 1 - r) : (BOARD_SIZE - 1 - c);
+                if (mr * BOARD_SIZE + mc < r * BOARD_SIZE + c) continue;
+                Opening *o = &openings[opening_count++];
+                o->moves[0] = CORPUS_MOVE(center, center);
+                o->moves[1] = CORPUS_MOVE(wr, wc);
+                o->moves[2] = CORPUS_MOVE(r, c);
+                o->count = 3;
+            }
+        }
+    }
+}
+
+static int collectOpening(void *user, const CorpusGame *game) {
+    (void)user;
+    if (opening_count >= MAX_OPENINGS) return 0;
+    Opening *o = &openings[opening_count++];
+    o->count = game->move_count < (int)sizeof(o->moves) ? game->move_count : (int)sizeof(o->moves);
+    memcpy(o->moves, game->moves, o->count);
+    return 1;
+}
+
+static int loadOpenings(const char *path, RuleType rule) {
+    GameFormat format = formatFromPath(path);
+    if (format == FORMAT_CORPUS) {
+        Corpus corpus;
+        if (!corpusOpen(&corpus, path)) return 0;
+        for (unsigned long long i = 0; i < corpus.game_count; i++) {
+            CorpusGame game;
+            if (corpusGame(&corpus, i, &game) && !collectOpening(NULL, &game)) break;
+        }
+        corpusClose(&corpus);
+        return opening_count > 0;
+    }
+    FILE *fp = fopen(path, (format == FORMAT_RENLIB) ? "rb" : "r");
+    if (!fp) return 0;
+    long long n = importGames(fp, format, rule, collectOpening, NULL, NULL);
+    fclose(fp);
+    return n > 0;
+}
+
+// --- 引擎进程 ---
+
+static int engineStart(Engine *e, const char *cmd) {
+    int to[2], from[2];
+    memset(e, 0, sizeof(*e));
+    if (pipe(to) != 0 || pipe(from) != 0) return 0;
+    e->pid = fork();
+    if (e->pid < 0) return 0;
+    if (e->pid == 0) {
+        dup2(to[0], STDIN_FILENO);
+        dup2(from[1], STDOUT_FILENO);
+        close(to[0]); close(to[1]); close(from[0]); close(from[1]);
+        execl("/bin/sh", "sh", "-c", cmd, (char *)NULL);
+        _exit(127);
+    }
+    close(to[0]);
+    close(from[1]);
+    e->to_fd = to[1];
+    e->from_fd = from[0];
+    return 1;
+}
+
+__attribute__((format(printf, 2, 3)))
+static int engineSend(Engine *e, const char *fmt, ...) {
+    char line[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(line, sizeof(line) - 1, fmt, ap);
+    va_end(ap);
+    if (n < 0 || n >= (int)sizeof(line) - 1) return 0;
+    line[n++] = '\n';
+    return write(e->to_fd, line, n) == n;
+}
+
+// 读一行（不含换行），超时或引擎退出时返回0
+static int engineReadLine(Engine *e, char *line, int size, double deadline) {
+    for (;;) {
+        char *nl = memchr(e->buf, '\n', e->len);
+        if (nl) {
+            int n = nl - e->buf;
+            int copy = (n < size - 1) ? n : size - 1;
+            memcpy(line, e->buf, copy);
+            line[copy] = 0;
+            if (copy > 0 && line[copy - 1] == '\r') line[copy - 1] = 0;
+            memmove(e->buf, nl + 1, e->len - n - 1);
+            e->len -= n + 1;
+            return 1;
+        }
+        if (e->len == (int)sizeof(e->buf)) e->len = 0; // 超长行直接丢弃
+        int wait = (int)(deadline - now_ms());
+        if (wait <= 0) return 0;
+        struct pollfd pfd = {e->from_fd, POLLIN, 0};
+        int r = poll(&pfd, 1, wait);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return 0;
+        ssize_t got = read(e->from_fd, e->buf + e->len, sizeof(e->buf) - e->len);
+        if (got <= 0) return 0;
+        e->len += got;
+    }
+}
+
+// 等待一个走法 "x,y"，忽略 MESSAGE / DEBUG 等信息行
+static int engineReadMove(Engine *e, double timeout_ms, int *row, int *col) {
+    char line[256];
+    double deadline = now_ms() + timeout_ms;
+    while (engineReadLine(e, line, sizeof(line), deadline)) {
+        int x, y;
+        if (sscanf(line, "%d,%d", &x, &y) == 2) {
+            *row = y;
+            *col = x;
+            return 1;
+        }
+        if (strncmp(line, "ERROR", 5) == 0) return 0;
+    }
+    return 0;
+}
+
+static int engineExpectOk(Engine *e, double timeout_ms) {
+    char line[256];
+    double deadline = now_ms() + timeout_ms;
+    while (engineReadLine(e, line, sizeof(line), deadline)) {
+        if (strncmp(line, "OK", 2) == 0) return 1;
+        if (strncmp(line, "ERROR", 5) == 0) return 0;
+    }
+    return 0;
+}
+
+static void engineStop(Engine *e) {
+    if (e->pid <= 0) return;
+    engineSend(e, "END");
+    close(e->to_fd);
+    close(e->from_fd);
+    // 给引擎一点时间正常退出
+    for (int i = 0; i < 50; i++) {
+        if (waitpid(e->pid, NULL, WNOHANG) == e->pid) return;
+        usleep(10000);
+    }
+    kill(e->pid, SIGKILL);
+    waitpid(e->pid, NULL, 0);
+}
+
+// --- 单盘对局 ---
+
+// 下一盘棋，engines[0] 是引擎1；返回引擎1的结果，走法写入 moves
+static int playGame(const MatchOptions *opt, const Opening *opening, int engine1_black,
+                    unsigned char *moves, int *count) {
+    Engine engines[2];
+    GameState game;
+    double move_timeout = opt->nodes ? NODES_MOVE_TIMEOUT_MS : opt->movetime + MOVE_GRACE_MS;
+    int result = RESULT_ERROR;
+    *count = 0;
+
+    for (int k = 0; k < 2; k++) {
+        if (!engineStart(&engines[k], opt->engine[k])) {
+            if (k == 1) engineStop(&engines[0]);
+            return RESULT_ERROR;
+        }
+    }
+    for (int k = 0; k < 2; k++) {
+        engineSend(&engines[k], "START %d", BOARD_SIZE);
+        if (!engineExpectOk(&engines[k], MOVE_GRACE_MS * 5)) {
+            // 不能开局的一方判负
+            result = (k == 0) ? RESULT_LOSS : RESULT_WIN;
+            goto done;
+        }
+        engineSend(&engines[k], "INFO rule %d", opt->rule == RULE_STANDARD ? 4 : 0);
+        engineSend(&engines[k], "INFO timeout_match 0");
+        engineSend(&engines[k], "INFO timeout_turn %d", opt->movetime);
+        if (opt->nodes) engineSend(&engines[k], "INFO max_nodes %llu", opt->nodes);
+    }
+
+    initGame(&game, MODE_PVP, opt->rule);
+    for (int i = 0; i < opening->count; i++) {
+        int m = opening->moves[i];
+        if (makeMove(&game, CORPUS_ROW(m), CORPUS_COL(m)) != VALID_MOVE) goto done;
+        moves[(*count)++] = opening->moves[i];
+    }
+
+    for (;;) {
+        // 轮到的一方：黑方是 engine1_black ? 引擎1 : 引擎2
+        int black_to_move = (game.currentPlayer == PLAYER_BLACK);
+        int k = (black_to_move == engine1_black) ? 0 : 1;
+        Engine *e = &engines[k];
+        int row, col;
+
+        if (!e->synced) {
+            // 第一次轮到它：用 BOARD 发送完整局面（1 为己方，2 为对方）
+            engineSend(e, "BOARD");
+            for (int i = 0; i < *count; i++) {
+                int own = ((i % 2 == 0) == black_to_move);
+                engineSend(e, "%d,%d,%d", CORPUS_COL(moves[i]), CORPUS_ROW(moves[i]), own ? 1 : 2);
+            }
+            engineSend(e, "DONE");
+            e->synced = 1;
+        } else {
+            engineSend(e, "TURN %d,%d", game.lastMove.col, game.lastMove.row);
+        }
+
+        // 超时、崩溃或非法落子（含黑方禁手）判负
+        if (!engineReadMove(e, move_timeout, &row, &col) || makeMove(&game, row, col) != VALID_MOVE) {
+            result = (k == 0) ? RESULT_LOSS : RESULT_WIN;
+            break;
+        }
+        moves[(*count)++] = CORPUS_MOVE(row, col);
+
+        if (checkWin(&game)) {
+            result = (k == 0) ? RESULT_WIN : RESULT_LOSS;
+            break;
+        }
+        if (isBoardFull(&game)) {
+            result = RESULT_DRAW;
+            break;
+        }
+    }
+
+done:
+    engineStop(&engines[0]);
+    engineStop(&engines[1]);
+    return result;
+}
+
+// --- 统计 ---
+
+static double eloFromScore(double s) {
+    if (s <= 0) return -INFINITY;
+    if (s >= 1) return INFINITY;
+    double elo = -400.0 * log10(1.0 / s - 1.0);
+    return elo == 0 ? 0 : elo; // 避免打印 -0.0
+}
+
+static double scoreFromElo(double elo) {
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+// 广义 SPRT 的对数似然比（正态近似）：LLR = N (s1 - s0)(2s - s0 - s1) / (2 var)
+static double sprtLLR(int wins, int draws, int losses, double elo0, double elo1) {
+    int n = wins + draws + losses;
+    if (n == 0 || (wins + draws == 0) || (losses + draws == 0)) return 0;
+    double s = (wins + 0.5 * draws) / n;
+    double var = (wins * pow(1 - s, 2) + draws * pow(0.5 - s, 2) + losses * pow(s, 2)) / n;
+    if (var <= 0) return 0;
+    double s0 = scoreFromElo(elo0), s1 = scoreFromElo(elo1);
+    return n * (s1 - s0) * (2 * s - s0 - s1) / (2 * var);
+}
+
+static void printStats(const MatchOptions *opt, int wins, int draws, int losses, double *llr_out) {
+    int n = wins + draws + losses;
+    if (n == 0) return;
+    double s = (wins + 0.5 * draws) / n;
+    double var = (wins * pow(1 - s, 2) + draws * pow(0.5 - s, 2) + losses * pow(s, 2)) / n;
+    double margin = 1.96 * sqrt(var / n);
+    double elo = eloFromScore(s);
+    double lo = eloFromScore(s - margin), hi = eloFromScore(s + margin);
+    double llr = sprtLLR(wins, draws, losses, opt->elo0, opt->elo1);
+    double lower = log(opt->beta / (1 - opt->alpha)), upper = log((1 - opt->beta) / opt->alpha);
+    printf("games %d: +%d =%d -%d  score %.1f%%  elo %.1f [%.1f, %.1f]  LLR %.2f [%.2f, %.2f]\n",
+           n, wins, draws, losses, 100 * s, elo, lo, hi, llr, lower, upper);
+    fflush(stdout);
+    *llr_out = llr;
+}
+
+// --- 主流程 ---
+
+int main(int argc, char *argv[]) {
+    MatchOptions opt = {{DEFAULT_ENGINE, DEFAULT_ENGINE}, 100, 0, 100, 0, RULE_STANDARD,
+                        0, 5, 0.05, 0.05, NULL, NULL};
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    opt.concurrency = cpus > 0 ? (int)cpus : 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--engine1") == 0 && i + 1 < argc) opt.engine[0] = argv[++i];
+        else if (strcmp(argv[i], "--engine2") == 0 && i + 1 < argc) opt.engine[1] = argv[++i];
+        else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) opt.games = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--concurrency") == 0 && i + 1 < argc) opt.concurrency = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--openings") == 0 && i + 1 < argc) opt.openings_path = argv[++i];
+        else if (strcmp(argv[i], "--movetime") == 0 && i + 1 < argc) opt.movetime = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--nodes") == 0 && i + 1 < argc) opt.nodes = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) opt.out_path = argv[++i];
+        else if (strcmp(argv[i], "--rules") == 0 && i + 1 < argc) {
+            opt.rule = (strcmp(argv[++i], "simple") == 0) ? RULE_NO_FORBIDDEN : RULE_STANDARD;
+        } else if (strcmp(argv[i], "--sprt") == 0 && i + 2 < argc) {
+            opt.elo0 = atof(argv[++i]);
+            opt.elo1 = atof(argv[++i]);
+            if (i + 2 < argc && argv[i + 1][0] != '-') {
+                opt.alpha = atof(argv[++i]);
+                opt.beta = atof(argv[++i]);
+            }
+        } else {
+            fprintf(stderr, "Usage: gomoku-match [--engine1 cmd] [--engine2 cmd] [--games N] [--concurrency K]\n"
+                            "       [--openings file] [--movetime ms | --nodes N] [--rules std|simple]\n"
+                            "       [--sprt elo0 elo1 [alpha beta]] [--out file]\n");
+            return 1;
+        }
+    }
+    if (opt.concurrency < 1) opt.concurrency = 1;
+
+    if (opt.openings_path) {
+        if (!loadOpenings(opt.openings_path, opt.rule)) {
+            fprintf(stderr, "gomoku-match: no openings in %s\n", opt.openings_path);
+            return 1;
+        }
+    } else {
+        generateOpenings();
+    }
+
+    GameExporter exporter;
+    int exporting = 0;
+    if (opt.out_path) {
+        exporting = exporterOpen(&exporter, opt.out_path, formatFromPath(opt.out_path));
+        if (!exporting) fprintf(stderr, "gomoku-match: cannot write %s\n", opt.out_path);
+    }
+
+    printf("engine1: %s\nengine2: %s\n%d games, %d openings, %d concurrent, %s %s\n",
+           opt.engine[0], opt.engine[1], opt.games, opening_count, opt.concurrency,
+           opt.nodes ? "nodes" : "movetime", opt.rule == RULE_STANDARD ? "renju" : "freestyle");
+    if (opt.nodes) printf("nodes per move: %llu\n", opt.nodes);
+    else printf("movetime: %d ms\n", opt.movetime);
+    fflush(stdout);
+
+    // 每盘棋在一个子进程中进行，结果以一行文本写回同一个管道（小于 PIPE_BUF，写入是原子的）
+    int results[2];
+    if (pipe(results) != 0) {
+        perror("pipe");
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    int started = 0, running = 0, finished = 0;
+    int wins = 0, draws = 0, losses = 0, errors = 0;
+    int stop = 0;
+    char pending[8192];
+    int pending_len = 0;
+    double llr = 0;
+    double lower = log(opt.beta / (1 - opt.alpha)), upper = log((1 - opt.beta) / opt.alpha);
+
+    while (running > 0 || (!stop && started < opt.games)) {
+        if (!stop && started < opt.games && running < opt.concurrency) {
+            int g = started++;
+            pid_t pid = fork();
+            if (pid == 0) {
+                close(results[0]);
+                unsigned char moves[MAX_MOVES];
+                int count;
+                const Opening *o = &openings[(g / 2) % opening_count];
+                int result = playGame(&opt, o, g % 2 == 0, moves, &count);
+                char line[MAX_MOVES * 3 + 64];
+                int n = snprintf(line, sizeof(line), "%d %d %d ", g, result, g % 2 == 0);
+                for (int i = 0; i < count; i++) n += snprintf(line + n, sizeof(line) - n, "%02x", moves[i]);
+                line[n++] = '\n';
+                ssize_t w = write(results[1], line, n);
+                _exit(w == n ? 0 : 1);
+            }
+            if (pid < 0) {
+                perror("fork");
+                stop = 1;
+                started--;
+                continue;
+            }
+            running++;
+            continue;
+        }
+
+        // 等一盘结束，读出管道中已有的结果
+        if (wait(NULL) > 0) running--;
+        finished++;
+        for (;;) {
+            struct pollfd pfd = {results[0], POLLIN, 0};
+            if (poll(&pfd, 1, 0) <= 0) break;
+            ssize_t got = read(results[0], pending + pending_len, sizeof(pending) - pending_len - 1);
+            if (got <= 0) break;
+            pending_len += got;
+        }
+        char *nl;
+        while ((nl = memchr(pending, '\n', pending_len)) != NULL) {
+            *nl = 0;
+            int g, result, black;
+            char hex[MAX_MOVES * 2 + 1] = {0};
+            if (sscanf(pending, "%d %d %d %450s", &g, &result, &black, hex) >= 3) {
+                if (result == RESULT_WIN) wins++;
+                else if (result == RESULT_DRAW) draws++;
+                else if (result == RESULT_LOSS) losses++;
+                else errors++;
+
+                if (exporting && result != RESULT_ERROR) {
+                    unsigned char moves[MAX_MOVES];
+                    int count = 0;
+                    for (int i = 0; hex[2 * i] && hex[2 * i + 1] && count < MAX_MOVES; i++) {
+                        unsigned int m;
+                        sscanf(hex + 2 * i, "%2x", &m);
+                        moves[count++] = (unsigned char)m;
+                    }
+                    // 以黑方视角记录结果
+                    int black_result = black ? result : RESULT_WIN - result;
+                    CorpusGame game = {moves, count, opt.rule,
+                                       black_result == RESULT_WIN ? CORPUS_RESULT_BLACK :
+                                       black_result == RESULT_LOSS ? CORPUS_RESULT_WHITE : CORPUS_RESULT_DRAW};
+                    exporterAdd(&exporter, &game);
+                }
+                printStats(&opt, wins, draws, losses, &llr);
+                if (llr >= upper || llr <= lower) stop = 1;
+            }
+            int consumed = nl - pending + 1;
+            memmove(pending, nl + 1, pending_len - consumed);
+            pending_len -= consumed;
+        }
+    }
+    close(results[0]);
+    close(results[1]);
+    if (exporting) exporterClose(&exporter);
+
+    printf("finished: %d games, %d errors\n", finished, errors);
+    printStats(&opt, wins, draws, losses, &llr);
+    if (llr >= upper) printf("SPRT: H1 accepted (elo >= %.1f)\n", opt.elo1);
+    else if (llr <= lower) printf("SPRT: H0 accepted (elo <= %.1f)\n", opt.elo0);
+    else printf("SPRT: inconclusive\n");
+    return 0;
+}
@@ -0,0 +1,616 @@
+// 微基准：在随机对局生成的局面与线上测量各底层原语的 ns/op 与 cycles/op，
+// 并交叉校验各评估内核/后端的结果逐位一致，以及整盘膨胀得到的候选点与逐格扫描一致
+// 用法: microbench [局面数]
+// 语料: 从中心开始随机落子得到的局面、这些局面上所有长度不小于5的线，
+//       以及每个候选点落子后经过该点的4条线（即 aiMakeMove 交给 evaluateLines4 的输入，含成五的情况）
+// 周期数优先使用 perf_event 的 CPU 周期计数器，不可用时退回 rdtsc（参考周期），都不可用时只给出 ns
+// 任何一项校验不一致时返回1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+#include "../include/types.h"
+#include "../include/board.h"
+#include "../include/rules.h"
+#include "../include/renju.h"
+#include "../include/bitboard.h"
+#include "../include/board256.h"
+#include "../include/evaluate.h"
+#include "../include/linetable.h"
+#include "../include/zobrist.h"
+#include "../include/ai.h"
+#include "../include/tt.h"
+
+#define DEFAULT_POSITIONS 256
+#define MAX_CANDIDATES 16    // 每个局面参与 make/unmake 测量的候选点数
+#define TRIALS 5             // 每项重复测量，取最快的一次
+#define TRIAL_NS 1e8         // 每次测量大约持续的时间（纳秒）
+#define TT_KEYS 65536
+// 五连的净分（整盘总分超过它的一半即视为已有五连）
+#define SCORE_FIVE_NET (SCORE_FIVE >> _SHIFT)
+
+// --- 计时 ---
+
+typedef enum { COUNTER_NONE, COUNTER_PERF, COUNTER_TSC } CounterKind;
+
+static CounterKind counter_kind = COUNTER_NONE;
+static int perf_fd = -1;
+
+static void counterInit(void) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    perf_fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (perf_fd >= 0) {
+        counter_kind = COUNTER_PERF;
+        return;
+    }
+#endif
+#ifdef HAVE_RDTSC
+    counter_kind = COUNTER_TSC;
+#endif
+}
+
+static const char *counterName(void) {
+    switch (counter_kind) {
+    case COUNTER_PERF: return "perf_event cpu-cycles";
+    case COUNTER_TSC: return "rdtsc (reference cycles)";
+    default: return "none";
+    }
+}
+
+static inline unsigned long long counterRead(void) {
+    if (counter_kind == COUNTER_PERF) {
+        unsigned long long value = 0;
+        if (read(perf_fd, &value, sizeof(value)) != sizeof(value)) return 0;
+        return value;
+    }
+#ifdef HAVE_RDTSC
+    if (counter_kind == COUNTER_TSC) return __rdtsc();
+#endif
+    return 0;
+}
+
+static double nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// 防止被测调用被优化掉
+static volatile unsigned long long sink;
+
+// 先试跑一次估计耗时，再重复执行使每次测量约 TRIAL_NS，取 TRIALS 次中最快的一次
+// 代码块每执行一次完成 ops 次操作（用可变参数传入，块内可以有逗号）
+#define MEASURE(name, ops, ...)                                                           \
+    do {                                                                                  \
+        long long ops_ = (ops);                                                           \
+        if (ops_ <= 0) break;                                                             \
+        double probe_ = nowNs();                                                          \
+        { __VA_ARGS__; }                                                                  \
+        probe_ = nowNs() - probe_;                                                        \
+        long long reps_ = (probe_ > 0) ? (long long)(TRIAL_NS / probe_) + 1 : 1;          \
+        double best_ns_ = 0, best_cycles_ = 0;                                            \
+        for (int trial_ = 0; trial_ < TRIALS; trial_++) {                                 \
+            unsigned long long c0_ = counterRead();                                       \
+            double t0_ = nowNs();                                                         \
+            for (long long rep_ = 0; rep_ < reps_; rep_++) { __VA_ARGS__; }               \
+            double ns_ = (nowNs() - t0_) / (double)(reps_ * ops_);                        \
+            double cycles_ = (double)(counterRead() - c0_) / (double)(reps_ * ops_);      \
+            if (trial_ == 0 || ns_ < best_ns_) {                                          \
+                best_ns_ = ns_;                                                           \
+                best_cycles_ = cycles_;                                                   \
+            }                                                                             \
+        }                                                                                 \
+        report((name), best_ns_, best_cycles_);                                           \
+    } while (0)
+
+static void report(const char *name, double ns, double cycles) {
+    if (counter_kind == COUNTER_NONE) printf("%-40s %10.2f %12s\n", name, ns, "-");
+    else printf("%-40s %10.2f %12.1f\n", name, ns, cycles);
+}
+
+// --- 语料 ---
+
+static unsigned long long rng_state = 0x9E3779B97F4A7C15ULL;
+
+static unsigned long long rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+typedef struct {
+    Line b, w;
+    int len;
+} LineSample;
+
+typedef struct {
+    GameState game;
+    Position moves[MAX_CANDIDATES]; // 当前行棋方可以走的候选点（黑方已排除禁手）
+    int move_count;
+} PositionSample;
+
+static PositionSample *positions;
+static int position_count;
+static LineSample *lines;
+static int line_count;
+static LineSample (*groups)[4]; // 落子后经过落子点的 [列, 行, 主对角线, 副对角线]，长度不足5的对角线 len 为0
+static int group_count;
+
+// 从中心开始在棋子邻域内随机落子，得到分布接近实战的局面；出现五连的那一步撤回并结束
+static void randomPosition(PositionSample *p, RuleType rule) {
+    GameState *game = &p->game;
+    Position moves[BOARD_SIZE * BOARD_SIZE];
+    int length = 6 + (int)(rng() % 90);
+
+    initGame(game, MODE_PVP, rule);
+    makeMove(game, BOARD_SIZE / 2, BOARD_SIZE / 2);
+    while (game->moveCount < length) {
+        int count = generateMoves(&game->bitBoard, moves);
+        if (count == 0) break;
+        Position m = moves[rng() % count];
+        GameState before = *game;
+        if (makeMove(game, m.row, m.col) != VALID_MOVE) continue;
+        if (checkWin(game)) {
+            *game = before;
+            break;
+        }
+    }
+
+    int count = generateMoves(&game->bitBoard, moves);
+    p->move_count = 0;
+    for (int i = 0; i < count && p->move_count < MAX_CANDIDATES; i++) {
+        Position m = moves[(i * 7 + (int)(rng() % 5)) % count];
+        if (getCell(game, m.row, m.col) != EMPTY) continue;
+        if (game->currentPlayer == PLAYER_BLACK && isForbidden(game, m.row, m.col)) continue;
+        int dup = 0;
+        for (int k = 0; k < p->move_count; k++) {
+            if (p->moves[k].row == m.row && p->moves[k].col == m.col) dup = 1;
+        }
+        if (!dup) p->moves[p->move_count++] = m;
+    }
+}
+
+static void addLine(LinePair pair, int len) {
+    if (len < 5) return;
+    lines[line_count].b = pair.black;
+    lines[line_count].w = pair.white;
+    lines[line_count].len = len;
+    line_count++;
+}
+
+static LineSample moveLine(LinePair pair, int len) {
+    LineSample l = {0, 0, 0};
+    if (len >= 5) {
+        l.b = pair.black;
+        l.w = pair.white;
+        l.len = len;
+    }
+    return l;
+}
+
+static void addMoveGroups(const PositionSample *p) {
+    BitBoardState board = p->game.bitBoard;
+    for (int k = 0; k < p->move_count; k++) {
+        int row = p->moves[k].row, col = p->moves[k].col;
+        int d1 = row - col + (BOARD_SIZE - 1), d2 = row + col;
+        updateBitBoard(&board, row, col, p->game.currentPlayer);
+        LineSample *g = groups[group_count++];
+        g[0] = moveLine(board.cols[col], BOARD_SIZE);
+        g[1] = moveLine(board.rows[row], BOARD_SIZE);
+        g[2] = moveLine(board.diag1[d1], BOARD_SIZE - abs(d1 - (BOARD_SIZE - 1)));
+        g[3] = moveLine(board.diag2[d2], BOARD_SIZE - abs(d2 - (BOARD_SIZE - 1)));
+        undoBitBoard(&board, row, col, p->game.currentPlayer);
+    }
+}
+
+static void buildCorpus(int count) {
+    positions = (PositionSample *)malloc(sizeof(PositionSample) * count);
+    lines = (LineSample *)malloc(sizeof(LineSample) * count * 72);
+    groups = malloc(sizeof(*groups) * count * MAX_CANDIDATES);
+    if (!positions || !lines || !groups) {
+        fprintf(stderr, "microbench: out of memory\n");
+        exit(1);
+    }
+    position_count = count;
+    line_count = 0;
+    group_count = 0;
+    for (int i = 0; i < count; i++) {
+        PositionSample *p = &positions[i];
+        randomPosition(p, RULE_STANDARD);
+        const BitBoardState *board = &p->game.bitBoard;
+        for (int k = 0; k < BOARD_SIZE; k++) {
+            addLine(board->cols[k], BOARD_SIZE);
+            addLine(board->rows[k], BOARD_SIZE);
+        }
+        for (int k = 0; k < BOARD_SIZE * 2 - 1; k++) {
+            int len = BOARD_SIZE - abs(k - (BOARD_SIZE - 1));
+            addLine(board->diag1[k], len);
+            addLine(board->diag2[k], len);
+        }
+        addMoveGroups(p);
+    }
+}
+
+// --- 交叉校验 ---
+
+static int failures = 0;
+
+static void checkFailed(const char *what, int index) {
+    if (failures < 10) fprintf(stderr, "mismatch: %s (sample %d)\n", what, index);
+    failures++;
+}
+
+static Lines4 packLines4(const LineSample *l, int side) {
+    Lines4 r;
+    Line v[4];
+    for (int k = 0; k < 4; k++) v[k] = side ? l[k].w : l[k].b;
+    r.low = (unsigned long long)v[0] | ((unsigned long long)v[1] << 32);
+    r.high = (unsigned long long)v[2] | ((unsigned long long)v[3] << 32);
+    return r;
+}
+
+static Lines4 maskLines4(const LineSample *l) {
+    Lines4 r;
+    r.low = ((1ULL << l[0].len) - 1) | (((1ULL << l[1].len) - 1) << 32);
+    r.high = ((1ULL << l[2].len) - 1) | (((1ULL << l[3].len) - 1) << 32);
+    return r;
+}
+
+static int hasFive(Line line) {
+    unsigned int m = line & (line >> 1);
+    m &= m >> 1;
+    m &= m >> 1;
+    m &= m >> 1;
+    return m != 0;
+}
+
+// 各 evaluateLines4 内核逐位一致；4条线中没有五连时与 evaluateLines2 的单线结果一致，
+// 有五连时按 evaluateLines2 的约定只给成五的线记分，同一次调用中其余线记0
+// 整线查表与 evaluateLines2 的单线结果一致
+static void checkLineKernels(void) {
+    EvalKernel saved = evaluateGetKernel();
+    DualLines *reference = (DualLines *)malloc(sizeof(DualLines) * group_count);
+    evaluateSetKernel(EVAL_KERNEL_GENERIC);
+    for (int i = 0; i < group_count; i++) {
+        reference[i] = evaluateLines4(packLines4(groups[i], 0), packLines4(groups[i], 1), maskLines4(groups[i]));
+    }
+
+    int before = failures, fives = 0;
+    for (int i = 0; i < group_count; i++) {
+        const LineSample *l = groups[i];
+        int five = 0;
+        for (int j = 0; j < 4; j++) five |= hasFive(l[j].b) || hasFive(l[j].w);
+        if (five) {
+            fives++;
+            continue;
+        }
+        const DualLines *out = &reference[i];
+        unsigned long long b_scores[4] = {out->me.low & 0xFFFFFFFF, out->me.low >> 32,
+                                          out->me.high & 0xFFFFFFFF, out->me.high >> 32};
+        unsigned long long w_scores[4] = {out->enemy.low & 0xFFFFFFFF, out->enemy.low >> 32,
+                                          out->enemy.high & 0xFFFFFFFF, out->enemy.high >> 32};
+        for (int j = 0; j < 4; j++) {
+            unsigned long long ref = evaluateLines2(l[j].b, l[j].w, l[j].len, l[j].w, l[j].b, l[j].len);
+            if (b_scores[j] != (ref & 0xFFFFFFFF) || w_scores[j] != (ref >> 32)) checkFailed("generic vs evaluateLines2", i);
+        }
+    }
+    printf("check evaluateLines4 [generic] vs evaluateLines2: %s (%d groups, %d with a five)\n",
+           failures == before ? "ok" : "MISMATCH", group_count, fives);
+
+    for (int k = EVAL_KERNEL_GENERIC + 1; k < EVAL_KERNEL_COUNT; k++) {
+        if (!evaluateSetKernel((EvalKernel)k)) continue;
+        before = failures;
+        for (int i = 0; i < group_count; i++) {
+            DualLines out = evaluateLines4(packLines4(groups[i], 0), packLines4(groups[i], 1), maskLines4(groups[i]));
+            if (memcmp(&out, &reference[i], sizeof(out)) != 0) checkFailed(evaluateKernelName((EvalKernel)k), i);
+        }
+        printf("check evaluateLines4 [%s] vs [generic]: %s\n", evaluateKernelName((EvalKernel)k),
+               failures == before ? "ok" : "MISMATCH");
+    }
+    free(reference);
+    evaluateSetKernel(saved);
+
+    if (lineTableReady()) {
+        before = failures;
+        for (int i = 0; i < line_count; i++) {
+            if (lineTableLookup(lines[i].b, lines[i].w, lines[i].len) !=
+                lineTableComputeEntry(lines[i].b, lines[i].w, lines[i].len)) {
+                checkFailed("lineTableLookup", i);
+            }
+        }
+        printf("check lineTableLookup vs evaluateLines2: %s\n", failures == before ? "ok" : "MISMATCH");
+    } else {
+        printf("check lineTableLookup: skipped (table not loaded, run make table)\n");
+    }
+}
+
+// 增量评估（aiMakeMove）、窗口评估与候选点评估三者一致，并与整盘扫描一致；撤销后状态与哈希完全恢复
+// 成五的一步例外：增量路径沿用 evaluateLines4 的约定（同一次调用中其余3条线记0），
+// 整盘扫描逐线记分，两者相差不到一个五连分，只比较增量路径之间是否一致
+static void checkIncremental(void) {
+    int before = failures, fives = 0;
+    for (int i = 0; i < position_count; i++) {
+        PositionSample *p = &positions[i];
+        Player me = p->game.currentPlayer;
+        SearchContext ctx;
+        aiContextInit(&ctx, &p->game, NULL);
+        SearchContext saved = ctx;
+        CandidateScore candidates[MAX_CANDIDATES];
+        evaluateCandidates(&ctx.board, &ctx.eval, p->moves, p->move_count, me, candidates);
+
+        for (int k = 0; k < p->move_count; k++) {
+            Position m = p->moves[k];
+            UndoInfo undo;
+            EvalState fresh;
+            aiMakeMove(&ctx, m.row, m.col, me, &undo);
+            scanBoard(&ctx.board, &fresh);
+
+            int delta = ctx.eval.total_score - saved.eval.total_score;
+            int five = ctx.eval.total_score >= SCORE_FIVE_NET / 2 || ctx.eval.total_score <= -SCORE_FIVE_NET / 2;
+            fives += five;
+            if (!five && ctx.eval.total_score != fresh.total_score) checkFailed("aiMakeMove vs scanBoard", i);
+            if (ctx.board.hash != calculateZobristHash(&ctx.board, (me == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK)) {
+                checkFailed("incremental hash", i);
+            }
+            int attack = (me == PLAYER_BLACK) ? ctx.eval.total_score : -ctx.eval.total_score;
+            if (candidates[k].attack != attack) checkFailed("evaluateCandidates vs aiMakeMove", i);
+            if (evaluateWindowDelta(&ctx.board, m.row, m.col) != delta) checkFailed("evaluateWindowDelta vs aiMakeMove", i);
+
+            aiUnmakeMove(&ctx, m.row, m.col, me, &undo);
+            if (memcmp(&ctx.board, &saved.board, sizeof(ctx.board)) != 0) checkFailed("unmake board", i);
+            if (memcmp(&ctx.eval, &saved.eval, sizeof(ctx.eval)) != 0) checkFailed("unmake eval", i);
+        }
+    }
+    printf("check aiMakeMove / evaluateWindowDelta / evaluateCandidates / scanBoard, unmake restore: %s (%d five moves)\n",
+           failures == before ? "ok" : "MISMATCH", fives);
+}
+
+// 逐格扫描得到的候选点：每个棋子米字形5x5邻域（3x3 加8个方向上距离为2的格子）内的空位，显式判断边界
+static Board256 scalarCandidates(const BitBoardState *board) {
+    Board256 r = board256Zero();
+    for (int col = 0; col < BOARD_SIZE; col++) {
+        Line stones = board->cols[col].side[0] | board->cols[col].side[1];
+        for (int row = 0; row < BOARD_SIZE; row++) {
+            if (!((stones >> row) & 1)) continue;
+            for (int dr = -2; dr <= 2; dr++) {
+                for (int dc = -2; dc <= 2; dc++) {
+                    int near = dr >= -1 && dr <= 1 && dc >= -1 && dc <= 1;
+                    int star = (dr % 2 == 0) && (dc % 2 == 0);
+                    int r2 = row + dr, c2 = col + dc;
+                    if (!(near || star) || r2 < 0 || r2 >= BOARD_SIZE || c2 < 0 || c2 >= BOARD_SIZE) continue;
+                    Line other = board->cols[c2].side[0] | board->cols[c2].side[1];
+                    if (!((other >> r2) & 1)) board256Set(&r, r2, c2);
+                }
+            }
+        }
+    }
+    return r;
+}
+
+// 整盘膨胀得到的候选点与逐格扫描一致：盘上每一格单独一子（覆盖四条边与四个角），以及语料中的局面
+static void checkCandidates(void) {
+    int before = failures;
+    for (int cell = 0; cell < BOARD_SIZE * BOARD_SIZE; cell++) {
+        BitBoardState board;
+        initBitBoard(&board);
+        updateBitBoard(&board, cell / BOARD_SIZE, cell % BOARD_SIZE, PLAYER_BLACK);
+        Board256 got = candidateBoard256(&board), expected = scalarCandidates(&board);
+        if (memcmp(&got, &expected, sizeof(got)) != 0) checkFailed("candidateBoard256 vs scalar scan (single stone)", cell);
+    }
+    for (int i = 0; i < position_count; i++) {
+        const BitBoardState *board = &positions[i].game.bitBoard;
+        Board256 got = candidateBoard256(board), expected = scalarCandidates(board);
+        if (memcmp(&got, &expected, sizeof(got)) != 0) checkFailed("candidateBoard256 vs scalar scan", i);
+    }
+    printf("check candidateBoard256 vs scalar scan: %s\n", failures == before ? "ok" : "MISMATCH");
+}
+
+// --- 测量 ---
+
+static void benchLines(void) {
+    int n = line_count & ~3;
+
+    MEASURE("evaluateLines2 (one line, both sides)", n, {
+        unsigned long long acc = 0;
+        for (int i = 0; i < n; i++) {
+            const LineSample *l = &lines[i];
+            acc += evaluateLines2(l->b, l->w, l->len, l->w, l->b, l->len);
+        }
+        sink = acc;
+    });
+
+    // 预先打包，只测内核本身
+    Lines4 *me = (Lines4 *)malloc(sizeof(Lines4) * group_count * 3);
+    Lines4 *enemy = me + group_count, *mask = me + 2 * group_count;
+    for (int g = 0; g < group_count; g++) {
+        me[g] = packLines4(groups[g], 0);
+        enemy[g] = packLines4(groups[g], 1);
+        mask[g] = maskLines4(groups[g]);
+    }
+    EvalKernel saved = evaluateGetKernel();
+    for (int k = 0; k < EVAL_KERNEL_COUNT; k++) {
+        char name[64];
+        if (!evaluateSetKernel((EvalKernel)k)) continue;
+        snprintf(name, sizeof(name), "evaluateLines4 [%s] (4 lines)", evaluateKernelName((EvalKernel)k));
+        MEASURE(name, group_count, {
+            unsigned long long acc = 0;
+            for (int g = 0; g < group_count; g++) {
+                DualLines out = evaluateLines4(me[g], enemy[g], mask[g]);
+                acc += out.me.low ^ out.enemy.high;
+            }
+            sink = acc;
+        });
+    }
+    evaluateSetKernel(saved);
+    free(me);
+
+    if (lineTableReady()) {
+        MEASURE("lineTableLookup (one line)", n, {
+            unsigned long long acc = 0;
+            for (int i = 0; i < n; i++) acc += lineTableLookup(lines[i].b, lines[i].w, lines[i].len);
+            sink = acc;
+        });
+    }
+}
+
+static void benchBoard(void) {
+    SearchContext *contexts = (SearchContext *)malloc(sizeof(SearchContext) * position_count);
+    long long total_moves = 0;
+    for (int i = 0; i < position_count; i++) {
+        aiContextInit(&contexts[i], &positions[i].game, NULL);
+        total_moves += positions[i].move_count;
+    }
+
+    MEASURE("aiMakeMove + aiUnmakeMove", total_moves, {
+        for (int i = 0; i < position_count; i++) {
+            SearchContext *ctx = &contexts[i];
+            Player me = positions[i].game.currentPlayer;
+            for (int k = 0; k < positions[i].move_count; k++) {
+                UndoInfo undo;
+                Position m = positions[i].moves[k];
+                aiMakeMove(ctx, m.row, m.col, me, &undo);
+                sink = (unsigned long long)ctx->eval.total_score;
+                aiUnmakeMove(ctx, m.row, m.col, me, &undo);
+            }
+        }
+    });
+
+    MEASURE("updateBitBoard + undoBitBoard", total_moves, {
+        for (int i = 0; i < position_count; i++) {
+            BitBoardState *board = &contexts[i].board;
+            Player me = positions[i].game.currentPlayer;
+            for (int k = 0; k < positions[i].move_count; k++) {
+                Position m = positions[i].moves[k];
+                updateBitBoard(board, m.row, m.col, me);
+                sink = board->hash;
+                undoBitBoard(board, m.row, m.col, me);
+            }
+        }
+    });
+
+    MEASURE("update + evaluateWindowDelta + undo", total_moves, {
+        for (int i = 0; i < position_count; i++) {
+            BitBoardState *board = &contexts[i].board;
+            Player me = positions[i].game.currentPlayer;
+            for (int k = 0; k < positions[i].move_count; k++) {
+                Position m = positions[i].moves[k];
+                updateBitBoard(board, m.row, m.col, me);
+                sink = (unsigned long long)evaluateWindowDelta(board, m.row, m.col);
+                undoBitBoard(board, m.row, m.col, me);
+            }
+        }
+    });
+
+    MEASURE("evaluateCandidates (per candidate)", total_moves, {
+        CandidateScore out[MAX_CANDIDATES];
+        for (int i = 0; i < position_count; i++) {
+            evaluateCandidates(&contexts[i].board, &contexts[i].eval, positions[i].moves,
+                               positions[i].move_count, positions[i].game.currentPlayer, out);
+            sink = (unsigned long long)out[0].attack;
+        }
+    });
+
+    MEASURE("generateMoves", position_count, {
+        Position moves[BOARD_SIZE * BOARD_SIZE];
+        for (int i = 0; i < position_count; i++) sink = (unsigned long long)generateMoves(&contexts[i].board, moves);
+    });
+
+    MEASURE("scanBoard", position_count, {
+        EvalState eval;
+        for (int i = 0; i < position_count; i++) {
+            scanBoard(&contexts[i].board, &eval);
+            sink = (unsigned long long)eval.total_score;
+        }
+    });
+
+    MEASURE("calculateZobristHash", position_count, {
+        for (int i = 0; i < position_count; i++) {
+            sink = calculateZobristHash(&contexts[i].board, positions[i].game.currentPlayer);
+        }
+    });
+
+    // 禁手判断：isForbidden 不看轮次，白方要走的局面也按黑方在该点落子来判断
+    MEASURE("isForbidden (standard rule)", total_moves, {
+        for (int i = 0; i < position_count; i++) {
+            for (int k = 0; k < positions[i].move_count; k++) {
+                sink = (unsigned long long)isForbidden(&positions[i].game, positions[i].moves[k].row,
+                                                       positions[i].moves[k].col);
+            }
+        }
+    });
+
+    free(contexts);
+}
+
+static void benchTT(void) {
+    TranspositionTable *tt = tt_create(16);
+    unsigned long long *keys = (unsigned long long *)malloc(sizeof(unsigned long long) * TT_KEYS);
+    for (int i = 0; i < TT_KEYS; i++) keys[i] = rng();
+
+    MEASURE("tt_save (16 MB table)", TT_KEYS, {
+        for (int i = 0; i < TT_KEYS; i++) {
+            Position move = {i % BOARD_SIZE, (i / BOARD_SIZE) % BOARD_SIZE};
+            tt_save(tt, keys[i], i & 7, i, TT_FLAG_EXACT, move);
+        }
+    });
+
+    MEASURE("tt_probe (16 MB table, hits)", TT_KEYS, {
+        unsigned long long acc = 0;
+        for (int i = 0; i < TT_KEYS; i++) {
+            int alpha = -1000000, beta = 1000000, value = 0;
+            Position move;
+            acc += tt_probe(tt, keys[i], 0, &alpha, &beta, &value, &move) + value;
+        }
+        sink = acc;
+    });
+
+    free(keys);
+    tt_destroy(tt);
+}
+
+int main(int argc, char *argv[]) {
+    int count = (argc > 1) ? atoi(argv[1]) : DEFAULT_POSITIONS;
+    if (count <= 0) count = DEFAULT_POSITIONS;
+
+    aiInit();
+    counterInit();
+    // 整线评分表由 make table 生成，存在时一起校验和测量
+    const char *table_path = getenv("GOMOKU_LINETABLE") ? getenv("GOMOKU_LINETABLE") : LINE_TABLE_PATH;
+    if (access(table_path, R_OK) == 0) lineTableLoad(table_path);
+    buildCorpus(count);
+
+    printf("backend: %s, kernel: %s, counter: %s\n", EVAL_BACKEND_NAME,
+           evaluateKernelName(evaluateGetKernel()), counterName());
+    printf("corpus: %d positions, %d lines, %d candidate moves\n\n", position_count, line_count, group_count);
+
+    checkLineKernels();
+    checkIncremental();
+    checkCandidates();
+    printf("\n%-40s %10s %12s\n", "primitive", "ns/op", "cycles/op");
+    benchLines();
+    benchBoard();
+    benchTT();
+
+    if (failures) {
+        printf("\n%d mismatches\n", failures);
+        return 1;
+    }
+    return 0;
+}
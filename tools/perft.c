@@ -0,0 +1,260 @@
+// perft：从给定局面枚举完整的走法树，统计每一层的节点数与每秒节点数，
+// 同时校验 make/unmake 路径（位棋盘、增量哈希、增量评估、禁手位图）在大量落子/撤销后保持一致
+// 用法: perft [选项] [局面...]
+//   局面为走法序列（坐标格式同棋谱，如 "H8 H9 I8"），省略时使用内置的几个局面
+//   --depth <N>     枚举深度（默认 3）
+//   --full          每个节点枚举所有空位，默认只枚举棋子米字形5x5邻域内的点（同搜索）
+//   --rules <std|simple>  规则（默认 std，黑方禁手点不展开）
+//   --fast          不做校验，只计时
+// 校验（每个节点）: 哈希与 calculateZobristHash 一致，EvalState 与重新 scanBoard 的结果一致，
+// 生成的走法与逐格判断的候选点集合减去 renjuForbidden 判定的禁手点一致，撤销后位棋盘与 EvalState 逐字节恢复。
+// 成五的一步是叶子节点；它的 EvalState 只在撤销后校验（见 tools/microbench.c 中关于五连的说明）。
+// 发现不一致时返回1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/types.h"
+#include "../include/board.h"
+#include "../include/rules.h"
+#include "../include/renju.h"
+#include "../include/bitboard.h"
+#include "../include/board256.h"
+#include "../include/evaluate.h"
+#include "../include/zobrist.h"
+#include "../include/ai.h"
+
+#define MAX_PERFT_DEPTH 8
+#define MAX_ERRORS_SHOWN 10
+
+static const char *default_positions[] = {
+    "H8",
+    "H8 H9 I8 G8 J9",
+    "H8 J8 H9 H10 G9 F10 I9 J9 G10 G8",
+    "H8 H9 F10 G9 I9 G7 G10 H10 I11 I10 F9 F7 G8 H7 E7 J11 H11 E8",
+    "A1 O15 H1 A8 O1 H15 A15 O8", // 边与角上的棋子，邻域在棋盘边缘被截断
+    NULL
+};
+
+typedef struct {
+    int full;
+    int check;
+    unsigned long long counts[MAX_PERFT_DEPTH + 1]; // 每一层的节点数
+    unsigned long long fives;                       // 以成五结束的叶子数
+    unsigned long long errors;
+} Perft;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static Player opponent(Player player) {
+    return (player == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK;
+}
+
+static void reportError(Perft *pf, int ply, Position move, const char *what) {
+    if (pf->errors < MAX_ERRORS_SHOWN) {
+        fprintf(stderr, "perft: %s after (%d, %d) at ply %d\n", what, move.row, move.col, ply);
+    }
+    pf->errors++;
+}
+
+// 一条线上是否有五连（含长连）
+static int lineHasFive(Line line) {
+    unsigned int m = line & (line >> 1);
+    m &= m >> 1;
+    m &= m >> 1;
+    m &= m >> 1;
+    return m != 0;
+}
+
+// player 刚在 (row, col) 落子后是否成五
+static int makesFive(const BitBoardState *board, int row, int col, Player player) {
+    int side = LINE_SIDE(player);
+    return lineHasFive(board->cols[col].side[side]) || lineHasFive(board->rows[row].side[side]) ||
+           lineHasFive(board->diag1[row - col + (BOARD_SIZE - 1)].side[side]) ||
+           lineHasFive(board->diag2[row + col].side[side]);
+}
+
+// 本节点要展开的点: 邻域候选点（或全部空位），标准规则下去掉黑方的禁手点
+static int perftMoves(Perft *pf, SearchContext *ctx, Player player, Position *moves) {
+    if (!pf->full) {
+        return renjuGenerateMoves(&ctx->board, (ctx->rule == RULE_STANDARD) ? &ctx->forbidden : NULL, player, moves);
+    }
+    Board256 empty = board256AndNot(board256Full(), occupiedBoard256(&ctx->board));
+    int count = 0;
+    int row, col;
+    while (board256PopFirst(&empty, &row, &col)) {
+        if (ctx->rule == RULE_STANDARD && player == PLAYER_BLACK &&
+            forbiddenMapTest(&ctx->forbidden, &ctx->board, row, col)) {
+            continue;
+        }
+        moves[count].row = row;
+        moves[count].col = col;
+        count++;
+    }
+    return count;
+}
+
+// 逐格判断的期望集合：所有空位，或者某个棋子米字形5x5邻域（3x3 加8个方向上距离为2的格子）内的空位。
+// 只读 cols 线上的棋子、显式判断边界，不经过整盘位棋盘的平移，生成器的平移出错时可以发现
+static Board256 expectedMoves(const BitBoardState *board, int full) {
+    Board256 r = board256Zero();
+    for (int row = 0; row < BOARD_SIZE; row++) {
+        for (int col = 0; col < BOARD_SIZE; col++) {
+            if (((board->cols[col].side[0] | board->cols[col].side[1]) >> row) & 1) continue;
+            int near = full;
+            for (int dr = -2; dr <= 2 && !near; dr++) {
+                for (int dc = -2; dc <= 2 && !near; dc++) {
+                    int r2 = row + dr, c2 = col + dc;
+                    if ((dr == 0 && dc == 0) || r2 < 0 || r2 >= BOARD_SIZE || c2 < 0 || c2 >= BOARD_SIZE) continue;
+                    if (!((dr >= -1 && dr <= 1 && dc >= -1 && dc <= 1) || (dr % 2 == 0 && dc % 2 == 0))) continue;
+                    near = ((board->cols[c2].side[0] | board->cols[c2].side[1]) >> r2) & 1;
+                }
+            }
+            if (near) board256Set(&r, row, col);
+        }
+    }
+    return r;
+}
+
+// 生成的走法 = 逐格判断的期望集合 - 禁手点（禁手点由 renjuForbidden 从头判断）
+static void checkMoves(Perft *pf, SearchContext *ctx, Player player, const Position *moves, int count, int ply,
+                       Position last) {
+    Board256 expected = expectedMoves(&ctx->board, pf->full);
+    Board256 got = board256Zero();
+    int row, col;
+    for (int i = 0; i < count; i++) board256Set(&got, moves[i].row, moves[i].col);
+    if (ctx->rule == RULE_STANDARD && player == PLAYER_BLACK) {
+        Board256 cells = expected;
+        while (board256PopFirst(&cells, &row, &col)) {
+            if (renjuForbidden(&ctx->board, row, col)) board256Reset(&expected, row, col);
+        }
+    }
+    if (memcmp(&expected, &got, sizeof(got)) != 0) reportError(pf, ply, last, "move generation / forbidden map mismatch");
+}
+
+static void checkNode(Perft *pf, SearchContext *ctx, Player to_move, int ply, Position last, int five) {
+    if (ctx->board.hash != calculateZobristHash(&ctx->board, to_move)) {
+        reportError(pf, ply, last, "incremental hash differs from calculateZobristHash");
+    }
+    if (!five) {
+        EvalState fresh;
+        scanBoard(&ctx->board, &fresh);
+        if (memcmp(&fresh, &ctx->eval, sizeof(fresh)) != 0) reportError(pf, ply, last, "EvalState differs from scanBoard");
+    }
+}
+
+static void perft(Perft *pf, SearchContext *ctx, Player player, int ply, int depth, Position last) {
+    Position moves[BOARD_SIZE * BOARD_SIZE];
+    int count = perftMoves(pf, ctx, player, moves);
+    if (pf->check) checkMoves(pf, ctx, player, moves, count, ply, last);
+
+    for (int i = 0; i < count; i++) {
+        int row = moves[i].row, col = moves[i].col;
+        BitBoardState board_before;
+        EvalState eval_before;
+        UndoInfo undo;
+        if (pf->check) {
+            board_before = ctx->board;
+            eval_before = ctx->eval;
+        }
+
+        aiMakeMove(ctx, row, col, player, &undo);
+        pf->counts[ply + 1]++;
+        int five = makesFive(&ctx->board, row, col, player);
+        pf->fives += five;
+        if (pf->check) checkNode(pf, ctx, opponent(player), ply + 1, moves[i], five);
+        if (!five && ply + 1 < depth) perft(pf, ctx, opponent(player), ply + 1, depth, moves[i]);
+        aiUnmakeMove(ctx, row, col, player, &undo);
+
+        if (pf->check && (memcmp(&board_before, &ctx->board, sizeof(board_before)) != 0 ||
+                          memcmp(&eval_before, &ctx->eval, sizeof(eval_before)) != 0)) {
+            reportError(pf, ply + 1, moves[i], "unmake did not restore the board / EvalState");
+        }
+    }
+}
+
+static int setupPosition(GameState *game, const char *moves, RuleType rule) {
+    char buf[1024];
+    initGame(game, MODE_PVP, rule);
+    strncpy(buf, moves, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = 0;
+    for (char *tok = strtok(buf, " "); tok; tok = strtok(NULL, " ")) {
+        int col = tok[0] - 'A';
+        int row = BOARD_SIZE - atoi(tok + 1);
+        if (makeMove(game, row, col) != VALID_MOVE) {
+            fprintf(stderr, "perft: illegal move %s in \"%s\"\n", tok, moves);
+            return 0;
+        }
+        if (checkWin(game)) {
+            fprintf(stderr, "perft: game is already over in \"%s\"\n", moves);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    int depth = 3;
+    int full = 0, check = 1;
+    RuleType rule = RULE_STANDARD;
+    const char *user_positions[64];
+    int user_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) depth = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--full") == 0) full = 1;
+        else if (strcmp(argv[i], "--fast") == 0) check = 0;
+        else if (strcmp(argv[i], "--rules") == 0 && i + 1 < argc) {
+            rule = (strcmp(argv[++i], "simple") == 0) ? RULE_NO_FORBIDDEN : RULE_STANDARD;
+        } else if (argv[i][0] != '-' && user_count < 64) {
+            user_positions[user_count++] = argv[i];
+        } else {
+            fprintf(stderr, "Usage: perft [--depth N] [--full] [--fast] [--rules std|simple] [\"H8 H9 ...\"...]\n");
+            return 1;
+        }
+    }
+    if (depth < 1) depth = 1;
+    if (depth > MAX_PERFT_DEPTH) depth = MAX_PERFT_DEPTH;
+    user_positions[user_count] = NULL;
+    const char **list = user_count ? user_positions : default_positions;
+
+    aiInit();
+    printf("perft: depth %d, %s moves, %s, checks %s\n", depth, full ? "all empty" : "neighbourhood",
+           rule == RULE_STANDARD ? "renju" : "freestyle", check ? "on" : "off");
+
+    unsigned long long total_nodes = 0, total_errors = 0;
+    double total_time = 0;
+    for (int p = 0; list[p]; p++) {
+        GameState game;
+        if (!setupPosition(&game, list[p], rule)) return 1;
+        printf("position %d: %s\n", p + 1, list[p]);
+
+        for (int d = 1; d <= depth; d++) {
+            Perft pf;
+            SearchContext ctx;
+            memset(&pf, 0, sizeof(pf));
+            pf.full = full;
+            pf.check = check;
+            aiContextInit(&ctx, &game, NULL);
+
+            double start = now_seconds();
+            perft(&pf, &ctx, game.currentPlayer, 0, d, game.lastMove);
+            double elapsed = now_seconds() - start;
+
+            unsigned long long nodes = 0;
+            for (int k = 1; k <= d; k++) nodes += pf.counts[k];
+            printf("  depth %d: leaves %llu fives %llu nodes %llu time %.3fs nps %.0f%s\n", d, pf.counts[d],
+                   pf.fives, nodes, elapsed, elapsed > 0 ? nodes / elapsed : 0, pf.errors ? "  ERRORS" : "");
+            total_nodes += nodes;
+            total_time += elapsed;
+            total_errors += pf.errors;
+        }
+    }
+    printf("total: nodes %llu time %.3fs nps %.0f errors %llu\n", total_nodes, total_time,
+           total_time > 0 ? total_nodes / total_time : 0, total_errors);
+    return total_errors ? 1 : 0;
+}